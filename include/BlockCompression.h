@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+// CPU encoders for the BCn block formats used by cooked textures. Each call
+// packs one 4x4 block; pixels are row-major, top row first.
+
+constexpr int BC1_BLOCK_BYTES = 8;
+constexpr int BC4_BLOCK_BYTES = 8;
+constexpr int BC5_BLOCK_BYTES = 16;
+constexpr int BC7_BLOCK_BYTES = 16;
+
+// rgba: 16 pixels x 4 bytes. Alpha is ignored (opaque 4-colour mode).
+void encodeBlockBC1(const uint8_t* rgba, uint8_t* out);
+// values: 16 single-channel samples
+void encodeBlockBC4(const uint8_t* values, uint8_t* out);
+// Two BC4 blocks: red then green
+void encodeBlockBC5(const uint8_t* red, const uint8_t* green, uint8_t* out);
+// rgba: 16 pixels x 4 bytes, encoded with BC7 mode 6 (one subset, RGBA endpoints)
+void encodeBlockBC7(const uint8_t* rgba, uint8_t* out);
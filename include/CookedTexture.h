@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Block-compressed texture with its full mip chain, written by the
+// asset_cooker tool (.ctex next to the source image) and uploaded as-is by
+// the runtime. Rows are stored bottom-up, matching the flipped stb loads.
+enum class CookedFormat : uint32_t {
+    BC1 = 1,    // RGB colour, 4 bpp
+    BC4 = 2,    // single channel masks (AO, roughness, metallic), 4 bpp
+    BC5 = 3,    // two channel normal maps (X, Y), 8 bpp
+    BC7 = 4,    // RGBA colour, 8 bpp
+};
+
+struct CookedMip {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> data;
+};
+
+struct CookedTexture {
+    CookedFormat format = CookedFormat::BC1;
+    bool srgb = false;          // colour data; mips were filtered in linear space
+    std::vector<CookedMip> mips;
+
+    // Describe the whole chain in the file; after a partial read mips[0] is
+    // level firstMip of it
+    int baseWidth = 0;
+    int baseHeight = 0;
+    int mipCount = 0;
+    int firstMip = 0;
+
+    size_t getByteSize() const;
+};
+
+const char* cookedFormatName(CookedFormat format);
+int cookedBlockBytes(CookedFormat format);
+
+// "assets/textures/wood.jpg" -> "assets/textures/wood.ctex"
+std::string cookedPathFor(const std::string& sourcePath);
+// True when the cooked file exists and is not older than its source
+bool isCookedUpToDate(const std::string& sourcePath, const std::string& cookedPath);
+
+// maxSize > 0 skips the levels whose larger side exceeds it (streaming)
+bool readCookedTexture(const std::string& path, CookedTexture& texture, int maxSize = 0);
+bool writeCookedTexture(const std::string& path, const CookedTexture& texture);
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Cubemap baked from an equirectangular panorama, stored as RGB9E5 (shared
+// exponent HDR, 4 bytes per texel) with its full mip chain. Skybox keeps the
+// result in cache/skybox so later runs skip the float decode and resampling.
+struct BakedCubemap {
+    int faceSize = 0;
+    int mipCount = 0;
+    // levels[mip * 6 + face], faces in GL_TEXTURE_CUBE_MAP_POSITIVE_X order
+    std::vector<std::vector<uint32_t>> levels;
+
+    const std::vector<uint32_t>& level(int mip, int face) const { return levels[mip * 6 + face]; }
+    size_t getByteSize() const;
+};
+
+uint32_t packRGB9E5(float r, float g, float b);
+
+// rgb: width x height x channels linear floats, bottom row first (flipped stb load)
+BakedCubemap bakeEquirectCubemap(const float* rgb, int width, int height, int channels, int faceSize);
+
+// "assets/skybox/night.hdr" -> "cache/skybox/night.cube"
+std::string bakedCubemapPathFor(const std::string& sourcePath);
+
+bool readBakedCubemap(const std::string& path, BakedCubemap& cubemap);
+bool writeBakedCubemap(const std::string& path, const BakedCubemap& cubemap);
@@ -1,11 +1,9 @@
 #pragma once
 #include "Shape.h"
 
+// Capped cylinder with an LOD chain: segments halve per level down to 8
 class Cylinder : public Shape {
 public:
     Cylinder(float radius = 0.5f, float height = 1.0f, int segments = 32);
     void draw(Shader& shader) override;
-
-private:
-    void build(float radius, float height, int segments);
 };
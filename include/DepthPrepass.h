@@ -0,0 +1,45 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include "Shader.h"
+
+// Optional depth-only pass before the lighting pass. When active the lighting
+// pass runs with GL_EQUAL and no depth writes, so lighting.frag shades each
+// pixel once. In Auto mode the pass is switched on and off from the overdraw
+// measured with an occlusion query (read back a frame later, never stalls).
+class DepthPrepass {
+public:
+    enum class Mode { Off, On, Auto };
+
+    DepthPrepass();
+    ~DepthPrepass();
+
+    void update(int pixelCount);
+    bool isActive() const { return active; }
+
+    Shader& beginDepthPass(const glm::mat4& view, const glm::mat4& projection);
+    void endDepthPass();
+
+    void beginShadingPass();
+    void endShadingPass();
+
+    void setMode(Mode newMode);
+    Mode getMode() const { return mode; }
+    float getOverdraw() const { return overdraw; }
+
+    float overdrawThreshold = 1.3f;
+
+private:
+    std::shared_ptr<Shader> shader;
+    Mode mode = Mode::Auto;
+    bool active = false;
+
+    unsigned int query = 0;
+    bool queryPending = false;
+    bool queryRunning = false;
+    float overdraw = 0.0f;
+
+    void beginQuery();
+    void endQuery();
+};
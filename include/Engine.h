@@ -4,34 +4,71 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <memory>
+#include <string>
 
 #include "Input.h"
+#include "GLState.h"
 #include "Shader.h"
+#include "ShaderVariants.h"
+#include "ShaderLibrary.h"
+#include "TextureLoader.h"
+#include "TextureManager.h"
+#include "MeshImporter.h"
+#include "MeshletCuller.h"
+#include "GpuDrivenRenderer.h"
+#include "TextureStreamer.h"
 #include "Scene.h"
 #include "ShadowMap.h"
+#include "RenderTargetPool.h"
+#include "GpuProfiler.h"
+#include "HeadlessContext.h"
 
 extern glm::vec3 cameraPos;
 extern glm::vec3 cameraFront;
 extern glm::vec3 cameraUp;
 
+// Size of the final render target and the FBO standing in for the window (0 when windowed)
+extern glm::ivec2 framebufferSize;
+extern unsigned int defaultFramebuffer;
+
 class Engine {
 public:
     Engine();
     ~Engine();
 
     int init(int width, int height, const char* title);
+    int initHeadless(int width, int height, int frames, const char* screenshotPath = nullptr);
     void run();
     void setScene(std::shared_ptr<Scene> scene);
 
+    // GPU memory for streamed texture levels; set before init
+    size_t textureBudgetBytes = 256 * 1024 * 1024;
+
 private:
+    std::unique_ptr<HeadlessContext> headless;
+    int headlessFrames = 0;
+    std::string screenshotPath;
+
     GLFWwindow* window;
     int width, height;
 
     std::unique_ptr<Input> input;
+    // First after the context so the other GL owners release their objects through it
+    std::unique_ptr<GLState> glState;
+    std::unique_ptr<RenderTargetPool> renderTargetPool;
+    std::unique_ptr<GpuProfiler> gpuProfiler;
+    std::unique_ptr<TextureArrayPool> textureArrays;
+    std::unique_ptr<TextureLoader> textureLoader;
+    std::unique_ptr<TextureManager> textureManager;
+    std::unique_ptr<TextureStreamer> textureStreamer;
+    std::unique_ptr<MeshImporter> meshImporter;
+    std::unique_ptr<MeshletCuller> meshletCuller;
+    std::unique_ptr<GpuDrivenRenderer> gpuDrivenRenderer;
 
-    std::unique_ptr<Shader> lightingShader;
-    std::unique_ptr<Shader> lampShader;
-    std::unique_ptr<Shader> depthShader;
+    std::unique_ptr<ShaderLibrary> shaderLibrary;
+    std::unique_ptr<ShaderVariants> lightingShaders;
+    std::shared_ptr<Shader> lampShader;
+    std::shared_ptr<Shader> depthShader;
 
     std::unique_ptr<ShadowMap> shadowMap;
 
@@ -42,6 +79,11 @@ private:
     float deltaTime;
     float lastFrame;
 
+    int initRenderer(GLADloadproc loader);
+    void reportStartup();
+    void runHeadless();
+    void saveScreenshot(const std::string& path);
+
     void processInput();
     void update();
     void render();
@@ -0,0 +1,102 @@
+#pragma once
+#include <glad/glad.h>
+
+// Entry points and enums used by the engine that are not part of the
+// GL 3.3 core profile glad was generated for. Everything here is optional:
+// check the matching flag in GLExt before calling a function pointer.
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH           0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS      0x87FE
+#endif
+
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR           0x91B1
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT    0x83F0
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT   0x8C4C
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM       0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER                  0x91B9
+#define GL_SHADER_STORAGE_BUFFER           0x90D2
+#define GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT 0x90DF
+#define GL_DRAW_INDIRECT_BUFFER            0x8F3F
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#define GL_TEXTURE_FETCH_BARRIER_BIT       0x00000008
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#define GL_COMMAND_BARRIER_BIT             0x00000040
+#define GL_BUFFER_UPDATE_BARRIER_BIT       0x00000200
+#define GL_SHADER_STORAGE_BARRIER_BIT      0x00002000
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT              0x0040
+#define GL_MAP_COHERENT_BIT                0x0080
+#define GL_DYNAMIC_STORAGE_BIT             0x0100
+#define GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT 0x00004000
+#endif
+#ifndef GL_PARAMETER_BUFFER_ARB
+#define GL_PARAMETER_BUFFER_ARB            0x80EE
+#endif
+
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint x, GLuint y, GLuint z);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+typedef void (APIENTRYP PFNGLBINDIMAGETEXTUREPROC)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+typedef void (APIENTRYP PFNGLCLEARBUFFERDATAPROC)(GLenum target, GLenum internalformat, GLenum format, GLenum type, const void* data);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+struct GLExtensions {
+    int versionMajor = 0;
+    int versionMinor = 0;
+
+    // GL 4.1 / ARB_get_program_binary
+    bool programBinary = false;
+    PFNGLGETPROGRAMBINARYPROC   GetProgramBinary   = nullptr;
+    PFNGLPROGRAMBINARYPROC      ProgramBinary      = nullptr;
+    PFNGLPROGRAMPARAMETERIPROC  ProgramParameteri  = nullptr;
+
+    // KHR/ARB_parallel_shader_compile: GL_COMPLETION_STATUS_KHR can be polled
+    bool parallelShaderCompile = false;
+    PFNGLMAXSHADERCOMPILERTHREADSKHRPROC MaxShaderCompilerThreads = nullptr;
+
+    // GL 4.3 compute, storage buffers and indirect multi-draw, plus GL 4.4 /
+    // ARB_buffer_storage for persistent mapping: the GPU-driven backend
+    bool gpuDriven = false;
+    PFNGLDISPATCHCOMPUTEPROC           DispatchCompute           = nullptr;
+    PFNGLMEMORYBARRIERPROC             MemBarrier                = nullptr;   // not MemoryBarrier: a macro in winnt.h
+    PFNGLBINDIMAGETEXTUREPROC          BindImageTexture          = nullptr;
+    PFNGLCLEARBUFFERDATAPROC           ClearBufferData           = nullptr;
+    PFNGLMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect = nullptr;
+    PFNGLBUFFERSTORAGEPROC             BufferStorage             = nullptr;
+
+    // GL 4.6 / ARB_indirect_parameters: the draw count comes from a buffer too
+    bool indirectParameters = false;
+    PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC MultiDrawElementsIndirectCount = nullptr;
+
+    // Block-compressed texture formats (RGTC/BC4-5 is core in 3.0)
+    bool textureCompressionS3TC = false;
+    bool textureCompressionS3TCSrgb = false;
+    bool textureCompressionBPTC = false;
+};
+
+extern GLExtensions GLExt;
+
+// Call once after gladLoadGLLoader with the same loader
+void loadGLExtensions(GLADloadproc load);
+bool hasGLExtension(const char* name);
@@ -0,0 +1,90 @@
+#pragma once
+#include <glad/glad.h>
+
+// Shadow copy of the GL state the passes touch: program, VAO, framebuffers,
+// viewport, textures per unit, and depth/cull/blend state. Setting a value
+// that is already current is skipped, so passes can state what they need
+// instead of restoring what the previous one might have changed.
+// Tracked state must only change through GGLState; code that binds textures
+// behind its back (uploads) calls invalidateTextures(). Every value starts
+// unknown, so the first set always reaches GL.
+class GLState {
+public:
+    struct Stats {
+        long long issued = 0;
+        long long elided = 0;
+    };
+
+    static constexpr int kMaxUnits = 16;
+
+    GLState();
+    ~GLState();
+
+    GLState(const GLState&) = delete;
+    GLState& operator=(const GLState&) = delete;
+
+    void useProgram(unsigned int program);
+    void bindVertexArray(unsigned int vao);
+    // GL_FRAMEBUFFER binds both the read and the draw target
+    void bindFramebuffer(GLenum target, unsigned int framebuffer);
+    void viewport(int x, int y, int width, int height);
+    // Returns false when the unit already held the texture. 2D, 2D array and
+    // cube map targets below kMaxUnits are tracked; others always bind.
+    bool bindTexture(int unit, GLenum target, unsigned int texture);
+
+    // GL_DEPTH_TEST, GL_CULL_FACE and GL_BLEND are tracked; others pass through
+    void setEnabled(GLenum capability, bool enabled);
+    void depthFunc(GLenum func);
+    void depthMask(bool write);
+    void cullFace(GLenum face);
+    void blendFunc(GLenum source, GLenum destination);
+    void colorMask(bool write);
+
+    // Asks GL only while the value is unknown
+    unsigned int getProgram();
+    unsigned int getDrawFramebuffer();
+
+    // Deleting a bound object rebinds 0 in GL; keep the copy in step
+    void forgetVertexArray(unsigned int vao);
+    void forgetFramebuffer(unsigned int framebuffer);
+    void forgetTexture(unsigned int texture);
+    void invalidateTextures();
+    void invalidate();
+
+    void beginFrame();
+    const Stats& getFrameStats() const { return frameStats; }
+    const Stats& getTotals() const { return totals; }
+
+private:
+    static constexpr unsigned int kUnknown = 0xFFFFFFFFu;
+    static constexpr int kTargets = 3;
+    static constexpr int kCapabilities = 3;
+
+    unsigned int program;
+    unsigned int vertexArray;
+    unsigned int readFramebuffer, drawFramebuffer;
+    int viewportRect[4];
+    int activeUnit;
+    unsigned int textures[kMaxUnits][kTargets];
+
+    int capabilities[kCapabilities];        // -1 unknown, else 0/1
+    unsigned int depthFuncValue, cullFaceValue;
+    unsigned int blendSource, blendDestination;
+    int depthWrite, colorWrite;
+
+    Stats frameStats;
+    Stats totals;
+
+    // True when value differs from current (which then takes it) and GL must be called
+    template <typename T>
+    bool change(T& current, T value) {
+        bool differs = !(current == value);
+        current = value;
+        count(differs);
+        return differs;
+    }
+    void count(bool issued);
+    void activeTexture(int unit);
+};
+
+extern GLState* GGLState;
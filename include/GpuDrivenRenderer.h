@@ -0,0 +1,146 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "MeshLod.h"
+#include "MeshletCuller.h"
+#include "Shader.h"
+#include "ShaderVariants.h"
+#include "Shape.h"
+
+// Optional GPU-driven backend (--gpu-driven, GL 4.3 + buffer storage).
+// Every LOD level of every shape's mesh is copied into one shared vertex and
+// index pool. Shape transforms, bounds and materials live in a persistently
+// mapped buffer, rewritten only for shapes that changed. Per pass, a compute
+// shader tests each object against the frustum and (main pass) the Hi-Z
+// pyramid of the previous frame's depth, picks its LOD level, and appends a
+// draw command plus per-draw attributes for the survivors. The pass is then
+// submitted with one glMultiDrawElementsIndirect per material group, so the
+// number of GL calls no longer grows with the object count.
+class GpuDrivenRenderer {
+public:
+    struct Stats {
+        long long frames = 0;
+        long long objects = 0;
+        long long multiDraws = 0;
+        double cpuMs = 0.0;
+        // Main pass counters, read back a few frames late without stalling
+        long long countedFrames = 0;
+        long long tested = 0;
+        long long frustumCulled = 0;
+        long long occluded = 0;
+        long long trianglesVisible = 0;
+    };
+
+    GpuDrivenRenderer();
+    ~GpuDrivenRenderer();
+
+    GpuDrivenRenderer(const GpuDrivenRenderer&) = delete;
+    GpuDrivenRenderer& operator=(const GpuDrivenRenderer&) = delete;
+
+    // Takes every shape whose meshes use the default vertex format and marks
+    // it Shape::batched; uploads what changed. Call before the frame's passes.
+    void update(const std::vector<std::shared_ptr<Shape>>& shapes);
+
+    // Fills the command buffer of a pass; the main pass can also reject
+    // objects hidden behind last frame's depth (see buildOcclusion)
+    void cull(LodPass pass, const CullView& view, const LodView& lodView, bool occlusion);
+    // Draws what the last cull of the pass kept
+    void drawDepth(LodPass pass, const glm::mat4& view, const glm::mat4& projection);
+    void draw(LodPass pass, ShaderVariants& shaders, uint32_t frameFeatures);
+
+    // After the main pass: reduces the bound framebuffer's depth into the
+    // Hi-Z pyramid the next frame's occlusion test reads
+    void buildOcclusion(const glm::mat4& viewProjection, int width, int height);
+    void endFrame();
+
+    const Stats& getStats() const { return stats; }
+
+    // --gpu-driven
+    static bool enabled;
+
+private:
+    struct Entry {
+        Shape* shape;
+        uint32_t firstMesh;
+        uint32_t levelCount;
+        uint32_t group;
+        uint64_t shapeVersion = 0;
+        int layer = -1;
+        uint64_t stamp = 0;                 // bumped whenever the object data changes
+        uint64_t written[3] = {};           // stamp last written to each ring region
+    };
+
+    // One LOD chain (or single mesh), its levels in consecutive table rows
+    struct PoolEntry {
+        std::vector<std::shared_ptr<Mesh>> meshes;
+        uint32_t firstRow;
+    };
+
+    struct Group {
+        uint32_t features;
+        const TextureArray* array;
+        std::shared_ptr<Texture> texture;   // any member's, to bind the array
+        uint32_t base = 0;
+        uint32_t capacity = 0;
+    };
+
+    struct PassBuffers {
+        unsigned int VAO = 0;
+        unsigned int commands = 0;
+        unsigned int draws = 0;
+        unsigned int counters = 0;
+    };
+
+    // Shapes as of the last update, to notice additions and removals
+    std::vector<Shape*> shapeList;
+    std::vector<Entry> entries;
+    std::vector<Group> groups;
+    uint64_t stampCounter = 0;
+    bool regroup = false;
+
+    std::unordered_map<const void*, PoolEntry> pool;
+    std::vector<glm::vec4> meshBounds;      // mesh-space sphere per mesh table row
+    unsigned int poolVBO = 0, poolEBO = 0;
+    unsigned int meshBuffer = 0, groupBuffer = 0, lodStateBuffer = 0;
+
+    unsigned int objectBuffer = 0;
+    uint8_t* objectMapped = nullptr;
+    size_t objectCapacity = 0;
+    size_t regionSize = 0;
+    int frame = 0;                          // ring region written this frame
+    GLsync fences[3] = {};
+
+    unsigned int statsBuffer = 0;
+    const uint32_t* statsMapped = nullptr;
+    bool statsPending[3] = {};
+
+    PassBuffers passes[LOD_PASS_COUNT];
+
+    unsigned int cullProgram = 0, reduceProgram = 0;
+    std::shared_ptr<Shader> depthShader;
+
+    unsigned int depthCopyFBO = 0, depthCopyTexture = 0, hiZTexture = 0;
+    int boundFramebuffer = -1;
+    int hiZWidth = 0, hiZHeight = 0;
+    int hiZLevels = 0;
+    bool hasOcclusion = false;
+    bool occlusionFailed = false;
+    glm::mat4 occlusionViewProjection = glm::mat4(1.0f);
+
+    Stats stats;
+
+    void rebuild(const std::vector<std::shared_ptr<Shape>>& shapes);
+    void buildPool(const std::vector<Shape*>& candidates);
+    void allocateObjects(size_t count);
+    void updateGroups();
+    void setupVertexArrays();
+    void writeObject(const Entry& entry, uint8_t* out) const;
+    void readStats(int region);
+    bool createOcclusionTargets(int framebuffer, int width, int height);
+};
+
+extern GpuDrivenRenderer* GGpuDrivenRenderer;
@@ -0,0 +1,79 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+// GPU pass timings from GL_TIMESTAMP queries. Each frame gets its own set of
+// query objects in a small ring; a frame's results are read back only when
+// its slot comes round again, and only if the GPU already has them, so the
+// profiler never waits on the pipeline.
+class GpuProfiler {
+public:
+    struct PassTiming {
+        const char* name;
+        int depth;
+        double milliseconds;
+    };
+
+    static const int kFrameLatency = 4;
+    static const int kMaxScopes    = 32;
+
+    GpuProfiler();
+    ~GpuProfiler();
+
+    void beginFrame();
+    void endFrame();
+
+    int  beginScope(const char* name);
+    void endScope(int scope);
+
+    // Latest frame whose queries have completed
+    const std::vector<PassTiming>& getResults() const { return results; }
+    double getFrameTime() const { return frameTime; }
+    std::string getSummary() const;
+
+private:
+    struct Scope {
+        const char* name;
+        int depth;
+        bool closed;
+    };
+
+    struct Frame {
+        unsigned int queries[kMaxScopes * 2 + 2];
+        Scope scopes[kMaxScopes];
+        int scopeCount = 0;
+        bool submitted = false;
+    };
+
+    Frame frames[kFrameLatency];
+    int current = 0;
+    int depth = 0;
+    bool inFrame = false;
+
+    std::vector<PassTiming> results;
+    double frameTime = 0.0;
+
+    void collect(Frame& frame);
+};
+
+extern GpuProfiler* GGpuProfiler;
+
+class GpuScope {
+public:
+    explicit GpuScope(const char* name)
+        : scope(GGpuProfiler ? GGpuProfiler->beginScope(name) : -1) {}
+    ~GpuScope() {
+        if (GGpuProfiler && scope >= 0) GGpuProfiler->endScope(scope);
+    }
+
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+    int scope;
+};
+
+#define GPU_SCOPE_CONCAT_(a, b) a##b
+#define GPU_SCOPE_CONCAT(a, b) GPU_SCOPE_CONCAT_(a, b)
+#define GPU_SCOPE(name) GpuScope GPU_SCOPE_CONCAT(gpuScope_, __LINE__)(name)
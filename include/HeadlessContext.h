@@ -0,0 +1,26 @@
+#pragma once
+#include <glad/glad.h>
+
+// Offscreen OpenGL 3.3 core context for running without a display. Uses EGL
+// (Mesa surfaceless platform when available, so it works on llvmpipe) and
+// renders into its own FBO, which stands in for the window framebuffer.
+class HeadlessContext {
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+
+    bool create();
+    bool createFramebuffer(int width, int height);
+
+    static void* getProcAddress(const char* name);
+
+    unsigned int framebuffer = 0;
+
+private:
+    unsigned int colorRenderbuffer = 0;
+    unsigned int depthRenderbuffer = 0;
+
+    void* display = nullptr;
+    void* context = nullptr;
+    void* surface = nullptr;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal read-only JSON document, enough for glTF. Missing members and
+// out-of-range elements return a shared null value, so lookups chain
+// without checks: json["meshes"][0]["primitives"].
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> elements;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    bool isNull() const { return type == Type::Null; }
+    size_t size() const { return type == Type::Array ? elements.size() : members.size(); }
+
+    const JsonValue& operator[](size_t index) const;
+    const JsonValue& operator[](const char* key) const;
+    bool has(const char* key) const { return !(*this)[key].isNull(); }
+
+    bool asBool(bool fallback = false) const { return type == Type::Bool ? boolean : fallback; }
+    double asNumber(double fallback = 0.0) const { return type == Type::Number ? number : fallback; }
+    int asInt(int fallback = -1) const { return type == Type::Number ? (int)number : fallback; }
+    const std::string& asString() const { return string; }
+};
+
+// Returns false and fills error on malformed input
+bool parseJson(const char* text, size_t length, JsonValue& out, std::string& error);
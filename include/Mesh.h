@@ -0,0 +1,110 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Meshlet.h"
+#include "VertexFormat.h"
+
+// Buffers already in their GPU layout. The pointers are not owned; they
+// may point into a mapped mesh cache file.
+struct PackedMeshView {
+    const VertexFormat* format = nullptr;
+    const void* vertices = nullptr;     // vertexCount * format->getStride() bytes
+    const void* positions = nullptr;    // vertexCount * format->getPositionStride() bytes
+    const void* indices = nullptr;      // indexCount 16- or 32-bit indices
+    int vertexCount = 0;
+    int indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_SHORT;
+    glm::mat4 dequantize = glm::mat4(1.0f);
+    const Meshlet* meshlets = nullptr;
+    int meshletCount = 0;
+};
+
+// Owning counterpart, produced by Mesh::pack
+struct PackedMesh {
+    const VertexFormat* format = nullptr;
+    std::vector<uint8_t> vertices;
+    std::vector<uint8_t> positions;
+    std::vector<uint8_t> indices;
+    int vertexCount = 0;
+    int indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_SHORT;
+    glm::mat4 dequantize = glm::mat4(1.0f);
+    std::vector<Meshlet> meshlets;      // empty unless built for cluster culling
+
+    PackedMeshView view() const;
+};
+
+// Indexed triangle mesh on the GPU. Takes interleaved position(3),
+// normal(3), uv(2) floats and stores them in the given VertexFormat.
+// Indices are stored as 16-bit whenever the vertex count allows.
+// Build through MeshBuilder to get deduplicated, cache-ordered data.
+class Mesh {
+public:
+    Mesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices,
+         const VertexFormat& format = VertexFormat::getDefault());
+    // Uploads straight from the given buffers, no repacking
+    explicit Mesh(const PackedMeshView& packed);
+    ~Mesh();
+
+    static PackedMesh pack(const std::vector<float>& vertices, const std::vector<unsigned int>& indices,
+                           const VertexFormat& format = VertexFormat::getDefault());
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    void draw() const;
+    // Same triangles through the position-only stream, for depth and shadow passes
+    void drawDepth() const;
+    // Like draw and drawDepth, but count indices of this mesh's index type
+    // from another buffer, e.g. the clusters that survived culling
+    void drawIndices(unsigned int buffer, size_t byteOffset, int count) const;
+    void drawDepthIndices(unsigned int buffer, size_t byteOffset, int count) const;
+    // Several ranges of the own index buffer in one glMultiDrawElements
+    void drawRanges(const std::vector<GLsizei>& counts, const std::vector<const void*>& byteOffsets, bool depthOnly) const;
+
+    // Copies the buffers back from the GPU as pos(3), normal(3), uv(2)
+    // floats in mesh space, e.g. to merge meshes. Slow; for load time.
+    void readBack(std::vector<float>& vertices, std::vector<unsigned int>& indices) const;
+    // GPU-side copy of the vertex buffer as stored, into another buffer
+    void copyVertices(unsigned int buffer, size_t byteOffset) const;
+
+    int getVertexCount() const { return vertexCount; }
+    int getIndexCount() const { return indexCount; }
+    size_t getByteSize() const;
+    unsigned int getVertexStride() const { return vertexStride; }
+    const VertexFormat* getFormat() const { return format; }
+    GLenum getIndexType() const { return indexType; }
+    size_t getIndexSize() const { return (indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(unsigned int); }
+
+    // Clusters and a CPU copy of the index buffer to compact them from; empty
+    // for meshes built without meshlets
+    const std::vector<Meshlet>& getMeshlets() const { return meshlets; }
+    const uint8_t* getIndexData() const { return indexData.data(); }
+
+    // Maps stored (possibly quantized) positions to mesh space; goes right of model
+    const glm::mat4& getDequantize() const { return dequantize; }
+
+    // Triangles submitted by every draw and drawDepth since startup
+    static long long trianglesDrawn;
+    // Vertex bytes those draws referenced, one vertex per index
+    static long long vertexBytesFetched;
+    // Draw calls those were, a multi-draw counting once
+    static long long drawCalls;
+
+private:
+    const VertexFormat* format = nullptr;
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    unsigned int depthVAO = 0, positionVBO = 0;
+    int vertexCount = 0;
+    int indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    unsigned int vertexStride = 0;
+    unsigned int positionStride = 0;
+    glm::mat4 dequantize = glm::mat4(1.0f);
+    std::vector<Meshlet> meshlets;
+    std::vector<uint8_t> indexData;
+
+    void drawRange(unsigned int vao, unsigned int buffer, size_t byteOffset, int count, unsigned int stride) const;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Mesh.h"
+
+// Collects triangles for a Mesh: merges identical vertices, reorders
+// triangles for the post-transform vertex cache (Forsyth's linear-speed
+// algorithm) and renumbers vertices in first-use order before upload.
+class MeshBuilder {
+public:
+    static constexpr int kFloatsPerVertex = 8;
+
+    // Totals over every mesh built so far, for the startup report
+    struct Stats {
+        int meshes = 0;
+        long long inputVertices = 0;    // before deduplication
+        long long vertices = 0;
+        long long triangles = 0;
+        size_t vertexBytes = 0;         // as uploaded, in the mesh's vertex format
+        double missesBefore = 0.0;      // simulated cache misses, generation order
+        double missesAfter = 0.0;       // after reordering
+    };
+
+    // position(3), normal(3), uv(2); returns the index of the merged vertex
+    unsigned int addVertex(const float* vertex);
+    void addTriangle(unsigned int a, unsigned int b, unsigned int c);
+    // Non-indexed triangle list, kFloatsPerVertex floats per vertex
+    void addTriangleSoup(const float* vertices, size_t vertexCount);
+    // Already indexed geometry; its vertices are merged like any other, unreferenced ones dropped
+    void addIndexed(const std::vector<float>& vertices, const std::vector<unsigned int>& indices);
+
+    size_t getTriangleCount() const { return indices.size() / 3; }
+    // Merged data as added so far, before any reordering
+    const std::vector<float>& getVertices() const { return vertices; }
+    const std::vector<unsigned int>& getIndices() const { return indices; }
+
+    std::shared_ptr<Mesh> build();
+    // Optimized and packed but not uploaded, e.g. for writing to a cache.
+    // With meshletTriangles > 0, meshes larger than that are also split into
+    // meshlets for cluster culling.
+    PackedMesh buildPacked(const VertexFormat& format = VertexFormat::getDefault(), int meshletTriangles = 0);
+
+    // Average cache misses per triangle for a FIFO cache of the given size
+    static float computeACMR(const std::vector<unsigned int>& indices, int vertexCount, int cacheSize = 16);
+
+    static const Stats& getStats() { return stats; }
+
+private:
+    struct VertexKey {
+        float data[kFloatsPerVertex];
+        bool operator==(const VertexKey& other) const;
+    };
+    struct VertexKeyHash {
+        size_t operator()(const VertexKey& key) const;
+    };
+
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    std::unordered_map<VertexKey, unsigned int, VertexKeyHash> lookup;
+    size_t inputVertices = 0;
+
+    static Stats stats;
+
+    void optimizeTriangleOrder();
+    void optimizeMeshletOrder(const std::vector<Meshlet>& meshlets);
+    void optimizeVertexOrder();
+};
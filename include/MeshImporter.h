@@ -0,0 +1,81 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Mesh.h"
+#include "MeshBuilder.h"
+#include "MeshLod.h"
+
+struct PackedPart;
+
+struct ImportedMaterial {
+    std::string name;
+    glm::vec3 baseColor = glm::vec3(1.0f);
+    std::string albedoPath;     // empty when the material has no base color texture
+    bool doubleSided = false;
+};
+
+// One mesh per material; parts share the model's coordinate space
+struct ImportedPart {
+    std::shared_ptr<Mesh> mesh;
+    int material = -1;
+    // Simplified levels after the full mesh, errors in model units; empty for small parts
+    std::vector<LodChain::Level> lods;
+};
+
+struct ImportedModel {
+    std::string path;
+    std::vector<ImportedMaterial> materials;
+    std::vector<ImportedPart> parts;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+};
+
+// Loads OBJ (with MTL) and glTF 2.0 (.gltf with local or data: buffers, .glb)
+// into optimized indexed meshes. The packed result is written to
+// cache/meshes; later runs map that file and upload it directly, without
+// parsing the source again. A cache entry is reused while it is newer than
+// the source and every file the source pulled in (.mtl, .bin).
+//
+// Each part also gets a chain of simplified levels (see simplifyMesh) at the
+// triangle ratios in lodRatios; they are cached next to the full mesh. Every
+// level is split into meshlets for cluster culling.
+class MeshImporter {
+public:
+    struct Stats {
+        int imported = 0;           // parsed from source
+        int cacheHits = 0;
+        int lodLevels = 0;          // simplified levels over all parts
+        double importMs = 0.0;
+        double cacheLoadMs = 0.0;
+        size_t uploadedBytes = 0;
+    };
+
+    // Shared per path while any shape still uses it; nullptr on failure
+    std::shared_ptr<const ImportedModel> load(const std::string& path);
+
+    const Stats& getStats() const { return stats; }
+
+    // Fractions of the full triangle count; a level is dropped when it saves
+    // less than 10% over the previous one. Changing them invalidates caches.
+    std::vector<float> lodRatios = { 0.5f, 0.25f, 0.1f };
+    // Parts below this many triangles are not simplified
+    size_t minLodTriangles = 256;
+    // Triangles per meshlet; 0 imports without meshlets
+    int meshletTriangles = Meshlet::kMaxTriangles;
+
+    // "assets/models/house.obj" -> "cache/meshes/house-<hash>.mesh"
+    static std::string cachePathFor(const std::string& sourcePath);
+
+private:
+    void packPart(MeshBuilder& builder, int material, std::vector<PackedPart>& packed) const;
+    uint32_t getSettingsKey() const;
+
+    std::unordered_map<std::string, std::weak_ptr<const ImportedModel>> entries;
+    Stats stats;
+};
+
+extern MeshImporter* GMeshImporter;
@@ -0,0 +1,57 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Mesh.h"
+
+// Passes keep separate LOD state so the shadow pass can run coarser
+// without disturbing the hysteresis of the main view
+enum LodPass {
+    LOD_PASS_MAIN = 0,
+    LOD_PASS_SHADOW = 1,
+    LOD_PASS_COUNT
+};
+
+// How one pass sees the scene, for projected-size estimates
+struct LodView {
+    glm::vec3 eye = glm::vec3(0.0f);
+    float pixelsPerUnit = 1.0f;     // perspective: at distance 1
+    bool orthographic = false;
+    int bias = 0;                   // extra levels coarser than the projected size asks for
+
+    static LodView perspective(const glm::vec3& eye, const glm::mat4& projection, int viewportHeight, int bias = 0);
+    static LodView ortho(float pixelsPerUnit, int bias = 0);
+};
+
+// Detail levels of one mesh, finest first, each with its geometric error:
+// how far its surface may be from the full-detail one, in object space.
+// Procedural chains are cached by parameter set and shared by every shape
+// built with it; imported models get theirs from the simplifier.
+class LodChain {
+public:
+    struct Level {
+        std::shared_ptr<Mesh> mesh;
+        float error = 0.0f;
+    };
+
+    std::vector<Level> levels;
+    float boundingRadius = 0.0f;    // object space
+
+    // Halves segments from `segments` down to `minSegments`; build makes one level.
+    // A level's error is the sagitta of its segments on the bounding radius.
+    static std::shared_ptr<LodChain> get(const std::string& key, int segments, int minSegments, float boundingRadius,
+                                         const std::function<std::shared_ptr<Mesh>(int segments)>& build);
+
+    // Level for an object at center with the given uniform scale: the coarsest
+    // whose error projects to at most targetErrorPixels. current is the level
+    // this pass used last time (-1 for none); switching coarser needs the error
+    // to stay under the target by `hysteresis`, so LODs do not flicker.
+    int select(const glm::vec3& center, float scale, const LodView& view, int current) const;
+
+    static float targetErrorPixels;
+    static float hysteresis;
+    // Extra coarsening for shadow passes; silhouettes in the shadow map are rarely seen up close
+    static int shadowLodBias;
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Quadric error metric simplification (Garland & Heckbert) for LOD chains.
+// Edges collapse onto one of their existing endpoints, so the result indexes
+// the input vertex array. Vertices sharing a position (normal or UV seams)
+// collapse together and only along the seam; mesh borders stay in place and
+// edges shared by more than two triangles are never moved.
+//
+// vertices: pos(3), normal(3), uv(2) floats each; indices: triangle list.
+// Stops at targetIndexCount indices, or earlier when every remaining collapse
+// would move the surface by more than maxError. Returns the geometric error
+// of the result in mesh units, an estimate of its distance to the input.
+float simplifyMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices,
+                   size_t targetIndexCount, float maxError, std::vector<unsigned int>& result);
@@ -0,0 +1,28 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// A cluster of triangles stored as one contiguous range of its mesh's index
+// buffer, with mesh-space bounds for culling (see MeshletCuller). Every
+// triangle normal lies within the cone around coneAxis; the cluster faces
+// away from any eye for which
+//     dot(center - eye, coneAxis) >= coneCutoff * length(center - eye) + radius
+struct Meshlet {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+    glm::vec3 coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    float coneCutoff = 2.0f;        // above 1 when the normals spread too far to ever cull
+
+    static const int kMaxTriangles = 128;
+};
+
+// Regroups a triangle list into clusters of up to maxTriangles. Each cluster
+// grows across shared edges, preferring triangles that face its way; inside a
+// cluster triangles keep their input order, so an earlier vertex cache
+// optimization mostly survives. vertices: pos(3), normal(3), uv(2) floats.
+// indices is rewritten in cluster order.
+std::vector<Meshlet> buildMeshlets(const std::vector<float>& vertices, std::vector<unsigned int>& indices,
+                                   int maxTriangles = Meshlet::kMaxTriangles);
@@ -0,0 +1,66 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Shape.h"
+#include "ThreadPool.h"
+
+// Frustum planes and eye of one pass
+struct CullView {
+    // xyz inward normal, w distance; world space. The default view accepts everything
+    glm::vec4 planes[6] = { glm::vec4(0, 0, 0, 1), glm::vec4(0, 0, 0, 1), glm::vec4(0, 0, 0, 1),
+                            glm::vec4(0, 0, 0, 1), glm::vec4(0, 0, 0, 1), glm::vec4(0, 0, 0, 1) };
+    glm::vec3 eye = glm::vec3(0.0f);
+    bool backfaces = false;         // cone test; off for passes that draw both sides
+
+    static CullView fromMatrix(const glm::mat4& viewProjection, const glm::vec3& eye, bool backfaces);
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const;
+    // World-space cone bounds as in Meshlet: true when every triangle faces away from the eye
+    bool facesAway(const glm::vec3& center, float radius, const glm::vec3& coneAxis, float coneCutoff) const;
+};
+
+// Per-pass culling of the meshlets of shapes whose current mesh has them.
+// Clusters outside the frustum or facing away from the eye are rejected on
+// worker threads; the indices of the survivors are then packed into one
+// stream buffer, uploaded once per pass, and each shape draws its range of
+// it instead of its whole index buffer. Run after selectLods for the pass.
+class MeshletCuller {
+public:
+    struct Stats {
+        long long passes = 0;
+        long long clustersTested = 0;
+        long long clustersVisible = 0;
+        long long trianglesTested = 0;
+        long long trianglesVisible = 0;
+        double cullMs = 0.0;
+    };
+
+    MeshletCuller();
+    ~MeshletCuller();
+
+    MeshletCuller(const MeshletCuller&) = delete;
+    MeshletCuller& operator=(const MeshletCuller&) = delete;
+
+    void cull(const std::vector<std::shared_ptr<Shape>>& shapes, const CullView& view);
+    // Full meshes again, for passes without a view to cull against
+    void reset(const std::vector<std::shared_ptr<Shape>>& shapes);
+
+    const Stats& getStats() const { return stats; }
+
+    // --no-cluster-culling: shapes always draw their full index buffer
+    static bool enabled;
+
+private:
+    struct Batch;
+
+    std::unique_ptr<ThreadPool> pool;
+    unsigned int indexBuffer = 0;
+    std::vector<uint8_t> staging;
+    Stats stats;
+
+    static void cullBatch(Batch& batch, const CullView& view);
+};
+
+extern MeshletCuller* GMeshletCuller;
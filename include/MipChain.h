@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Float image used for offline filtering (mip chains, format conversion)
+struct FloatImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<float> pixels;
+
+    float* at(int x, int y) { return &pixels[((size_t)y * width + x) * channels]; }
+    const float* at(int x, int y) const { return &pixels[((size_t)y * width + x) * channels]; }
+};
+
+// Halves the image with a separable Lanczos-2 filter. wrap selects repeat
+// addressing (tiling textures) instead of clamp-to-edge at the borders.
+FloatImage downsampleImage(const FloatImage& source, bool wrap);
+
+// Base level followed by every mip down to 1x1
+std::vector<FloatImage> buildMipChain(FloatImage base, bool wrap);
@@ -0,0 +1,24 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "Shape.h"
+#include "MeshImporter.h"
+
+// One part of an imported model. The lighting shaders take one material per
+// shape, so a model with several materials becomes several Model shapes;
+// give them the same transform to keep them together. Every part is fitted
+// with the bounds of the whole model into a unit cube around the origin, so
+// setScale and collision behave as for the primitives. Parts the importer
+// simplified switch levels by projected error like the procedural shapes.
+class Model : public Shape {
+public:
+    Model(std::shared_ptr<const ImportedModel> source, size_t partIndex);
+    void draw(Shader& shader) override;
+
+    // All parts of the model at path, empty if it failed to import
+    static std::vector<std::shared_ptr<Model>> load(const std::string& path);
+
+private:
+    std::shared_ptr<const ImportedModel> source;
+};
@@ -20,11 +20,14 @@ private:
     unsigned int FBO;
     unsigned int colorTexture;
     unsigned int depthTexture;
+    int width, height;
     unsigned int VAO, VBO;
-    std::unique_ptr<Shader> shader;
+    std::shared_ptr<Shader> shader;
     
     glm::mat4 prevViewProjection;
     bool firstFrame;
 
     void initRenderData();
+    void acquireTargets(int width, int height);
+    void releaseTargets();
 };
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #else
+    #include <x86intrin.h>
+  #endif
+  #define PROFILER_USE_TSC 1
+#else
+  #include <chrono>
+#endif
+
+// CPU zone profiler. Every thread writes finished zones into its own ring
+// buffer (single writer, no locks); dumpChromeTrace() writes the most recent
+// events of all threads as Chrome trace-event JSON (chrome://tracing, Perfetto).
+// Zones only exist when ENGINE_PROFILE is defined; release builds compile
+// the macros to nothing.
+class Profiler {
+public:
+    struct Event {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    struct ThreadBuffer {
+        static const uint64_t kCapacity = 1 << 16;
+
+        Event events[kCapacity];
+        std::atomic<uint64_t> head{0};
+        uint32_t threadIndex = 0;
+        std::string threadName;
+    };
+
+    static uint64_t now() {
+#ifdef PROFILER_USE_TSC
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    static ThreadBuffer* threadBuffer() {
+        if (!tlsBuffer) tlsBuffer = registerThread();
+        return tlsBuffer;
+    }
+
+    static void record(ThreadBuffer* buffer, const char* name, uint64_t start, uint64_t end) {
+        uint64_t index = buffer->head.load(std::memory_order_relaxed);
+        buffer->events[index & (ThreadBuffer::kCapacity - 1)] = { name, start, end };
+        buffer->head.store(index + 1, std::memory_order_release);
+    }
+
+    // Call on the main thread before any worker starts, so it gets the first slot
+    static void init();
+    static void setThreadName(const char* name);
+    static bool dumpChromeTrace(const char* path);
+
+private:
+    static thread_local ThreadBuffer* tlsBuffer;
+    static ThreadBuffer* registerThread();
+};
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : name(name), buffer(Profiler::threadBuffer()), start(Profiler::now()) {}
+    ~ProfileZone() { Profiler::record(buffer, name, start, Profiler::now()); }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name;
+    Profiler::ThreadBuffer* buffer;
+    uint64_t start;
+};
+
+#ifdef ENGINE_PROFILE
+  #define PROFILE_CONCAT_(a, b) a##b
+  #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+  #define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+  #define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+  #define PROFILE_INIT() Profiler::init()
+  #define PROFILE_THREAD_NAME(name) Profiler::setThreadName(name)
+  #define PROFILE_DUMP(path) Profiler::dumpChromeTrace(path)
+#else
+  #define PROFILE_SCOPE(name) ((void)0)
+  #define PROFILE_FUNCTION() ((void)0)
+  #define PROFILE_INIT() ((void)0)
+  #define PROFILE_THREAD_NAME(name) ((void)0)
+  #define PROFILE_DUMP(path) ((void)0)
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+
+enum class RenderTargetUsage {
+    Color,
+    Depth
+};
+
+struct RenderTargetDesc {
+    int width;
+    int height;
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+    RenderTargetUsage usage;
+
+    bool operator==(const RenderTargetDesc& other) const {
+        return width == other.width && height == other.height &&
+               internalFormat == other.internalFormat &&
+               format == other.format && type == other.type &&
+               usage == other.usage;
+    }
+};
+
+// Pool of framebuffer attachment textures. A texture handed back with release()
+// stays allocated and is reused by the next acquire() with an identical desc,
+// so scene reloads do not reallocate render targets. Free textures that stay
+// unused for a while (e.g. the old size after a window resize) are deleted.
+class RenderTargetPool {
+public:
+    ~RenderTargetPool();
+
+    unsigned int acquire(const RenderTargetDesc& desc);
+    void release(unsigned int texture);
+
+    void beginFrame();
+    int getFrameAllocations() const { return frameAllocations; }
+    int getTotalAllocations() const { return totalAllocations; }
+
+private:
+    struct Entry {
+        RenderTargetDesc desc;
+        unsigned int texture;
+        bool inUse;
+        long long lastUsedFrame;
+    };
+
+    std::vector<Entry> entries;
+
+    long long frameIndex = 0;
+    int frameAllocations = 0;
+    int totalAllocations = 0;
+
+    unsigned int allocate(const RenderTargetDesc& desc);
+};
+
+extern RenderTargetPool* GRenderTargetPool;
@@ -1,5 +1,6 @@
 #pragma once
 #include "Shader.h"
+#include "ShaderVariants.h"
 #include <glm/glm.hpp>
 
 class Scene {
@@ -7,10 +8,10 @@ public:
     virtual ~Scene() = default;
     virtual void load() = 0;
     virtual void update(float deltaTime) = 0;
-    virtual void draw(Shader&, Shader&, const glm::mat4& view, const glm::mat4& proj) = 0;
+    virtual void draw(ShaderVariants& lightingShaders, Shader& lampShader, const glm::mat4& view, const glm::mat4& proj) = 0;
 
 
-    virtual void drawShadow(Shader& shadowShader) = 0;
-    virtual void drawDepth(Shader& depthShader) = 0;
+    virtual void drawShadow(Shader& shadowShader, const glm::mat4& lightSpaceMatrix) = 0;
+    virtual void drawDepth(Shader& depthShader, const glm::mat4& lightSpaceMatrix) = 0;
     virtual glm::vec3 getLightPos() const = 0;
 };
\ No newline at end of file
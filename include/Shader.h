@@ -7,21 +7,44 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <cstdint>
 
 class Shader {
 public:
     unsigned int ID;
 
-    Shader(const char* vertexPath, const char* fragmentPath);
+    Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines = {});
     
     void use();
 
+    // Compiles submitted through ShaderLibrary link in the background; use()
+    // waits for the link only if the program is still pending.
+    bool isPending() const { return pending; }
+    bool pollCompletion();
+    void finish();
+
     void setBool(const std::string &name, bool value) const;
     void setInt(const std::string &name, int value) const;
     void setFloat(const std::string &name, float value) const;
+    void setMat3(const std::string &name, const glm::mat3 &mat) const;
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
     void setVec3(const std::string &name, const glm::vec3 &value) const;
 
 private:
-    void checkCompileErrors(unsigned int shader, std::string type);
+    friend class ShaderLibrary;
+
+    unsigned int vertexShader = 0;
+    unsigned int fragmentShader = 0;
+    uint64_t cacheKey = 0;
+    bool pending = false;
+
+    Shader() : ID(0) {}
+
+    static bool readSources(const char* vertexPath, const char* fragmentPath,
+                            const std::vector<std::string>& defines,
+                            std::string& vertexCode, std::string& fragmentCode);
+    void submit(const std::string& vertexCode, const std::string& fragmentCode);
+
+    bool checkCompileErrors(unsigned int shader, std::string type);
 };
\ No newline at end of file
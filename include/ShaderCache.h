@@ -0,0 +1,33 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries (glGetProgramBinary). Entries are
+// keyed by a hash of the shader sources and the driver vendor/renderer/version,
+// so a driver update or an edited shader simply misses and recompiles.
+class ShaderCache {
+public:
+    struct Stats {
+        int hits = 0;
+        int misses = 0;
+        double loadMs = 0.0;
+        double compileMs = 0.0;
+    };
+
+    static bool enabled;
+    static std::string directory;
+    static Stats stats;
+
+    static bool isAvailable();
+    static uint64_t makeKey(const std::vector<std::string>& sources);
+
+    // Returns a linked program, or 0 on a miss / rejected binary
+    static unsigned int load(uint64_t key);
+    static void prepare(unsigned int program);
+    static void store(uint64_t key, unsigned int program);
+
+private:
+    static std::string pathFor(uint64_t key);
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Shader.h"
+
+// Owns every linked program. Requests with the same preprocessed sources
+// (file contents plus injected defines) share one program, whatever path
+// they were loaded from. New programs are only submitted to the driver;
+// poll() picks up finished links and finishAll() waits for the rest, so a
+// scene load queues all its compiles before blocking on any of them.
+class ShaderLibrary {
+public:
+    struct Stats {
+        int requests = 0;
+        int programs = 0;
+        int deduplicated = 0;
+    };
+
+    ShaderLibrary();
+
+    std::shared_ptr<Shader> load(const std::string& vertexPath, const std::string& fragmentPath,
+                                 const std::vector<std::string>& defines = {});
+
+    void poll();
+    void finishAll();
+
+    size_t getPendingCount() const { return pending.size(); }
+    const Stats& getStats() const { return stats; }
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<Shader>> programs;
+    std::vector<std::shared_ptr<Shader>> pending;
+    Stats stats;
+};
+
+extern ShaderLibrary* GShaderLibrary;
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Shader.h"
+
+// Feature bits for the lighting shader. Material bits come from the shape,
+// the rest from the renderer's current settings.
+enum ShaderFeature : uint32_t {
+    FEATURE_ALBEDO_MAP = 1u << 0,
+    FEATURE_LIGHTING   = 1u << 1,
+    FEATURE_SHADOWS    = 1u << 2,
+    FEATURE_GPU_DRIVEN = 1u << 3,   // per-draw data from vertex attributes, see GpuDrivenRenderer
+};
+
+// Compile-time specialisations of one vertex/fragment pair. Bit i of the
+// feature mask becomes "#define <featureDefines[i]>"; a variant is requested
+// from GShaderLibrary the first time its mask is used, so calling get() early
+// only queues the compile. Per-frame uniforms are registered once with
+// addFrameSetup() and applied to each variant the first time it is selected
+// in a frame.
+class ShaderVariants {
+public:
+    ShaderVariants(std::string vertexPath, std::string fragmentPath, std::vector<std::string> featureDefines);
+
+    Shader& get(uint32_t features);
+    Shader& select(uint32_t features);
+
+    void beginFrame();
+    void addFrameSetup(std::function<void(Shader&)> setup);
+
+    size_t getVariantCount() const { return variants.size(); }
+
+private:
+    struct Variant {
+        std::shared_ptr<Shader> shader;
+        unsigned long long setupFrame = 0;
+    };
+
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::vector<std::string> featureDefines;
+
+    std::unordered_map<uint32_t, Variant> variants;
+    std::vector<std::function<void(Shader&)>> frameSetups;
+    unsigned long long frame = 1;
+
+    Variant& getVariant(uint32_t features);
+};
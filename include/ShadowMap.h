@@ -1,7 +1,10 @@
 #pragma once
 #include <glad/glad.h>
+#include "GLState.h"
 #include <iostream>
 
+extern unsigned int defaultFramebuffer;
+
 class ShadowMap {
 public:
     unsigned int depthMapFBO = 0;
@@ -15,7 +18,7 @@ public:
         glGenFramebuffers(1, &depthMapFBO);
 
         glGenTextures(1, &depthMap);
-        glBindTexture(GL_TEXTURE_2D, depthMap);
+        GGLState->bindTexture(0, GL_TEXTURE_2D, depthMap);
 
         // Узгоджений формат: depth component float
         glTexImage2D(
@@ -38,7 +41,7 @@ public:
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LESS);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+        GGLState->bindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
 
         glDrawBuffer(GL_NONE);
@@ -48,18 +51,19 @@ public:
             std::cout << "ERROR::FRAMEBUFFER:: Shadow Framebuffer is not complete!\n";
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GGLState->bindFramebuffer(GL_FRAMEBUFFER, 0);
+        GGLState->bindTexture(0, GL_TEXTURE_2D, 0);
     }
 
     void bind() {
-        glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+        GGLState->viewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+        GGLState->bindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+        GGLState->depthMask(true);
         glClear(GL_DEPTH_BUFFER_BIT);
     }
 
     void unbind(int scrWidth, int scrHeight) {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glViewport(0, 0, scrWidth, scrHeight);
+        GGLState->bindFramebuffer(GL_FRAMEBUFFER, defaultFramebuffer);
+        GGLState->viewport(0, 0, scrWidth, scrHeight);
     }
 };
@@ -4,14 +4,18 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include "Shader.h"
 #include "Texture.h"
+#include "MeshLod.h"
 
 class Shape {
 public:
     Shape();
     virtual ~Shape();
     virtual void draw(Shader& shader) = 0;
+    // Geometry only, through the mesh's position stream; no material state
+    void drawDepth(Shader& shader) const;
 
     void setPosition(glm::vec3 pos);
     void rotate(float angle, glm::vec3 axis);
@@ -19,6 +23,30 @@ public:
     void setColor(glm::vec3 newColor);
     glm::vec3 getColor() const;
     void addTexture(std::shared_ptr<Texture> tex);
+    uint32_t getMaterialFeatures() const { return materialFeatures; }
+    // Reports the on-screen size of the textures for mip streaming
+    void requestTextureDetail(const glm::vec3& eye) const;
+    // Picks the tessellation level the following draws use; shapes without
+    // an LOD chain ignore it
+    void selectLod(const LodView& view, LodPass pass);
+    int getLodLevel() const { return activeLod; }
+
+    // Cluster culling (see MeshletCuller): the mesh the next draws use and
+    // where it sits in the world. While the current mesh is still `mesh`,
+    // draws take the culled indices at byteOffset in buffer instead.
+    const Mesh* getCurrentMesh() const;
+    glm::mat4 getMeshMatrix() const { return model * meshTransform; }
+    const glm::mat3& getNormalMatrix() const { return normalMatrix; }
+    bool isDoubleSided() const { return doubleSided; }
+    void setVisibleIndices(const Mesh* mesh, unsigned int buffer, size_t byteOffset, int count);
+    void clearVisibleIndices() { visibleMesh = nullptr; }
+
+    // Static batching (see StaticBatcher): every LOD level, finest first, and
+    // a number that changes whenever the transform or material does
+    std::vector<std::shared_ptr<Mesh>> getLodMeshes() const;
+    const LodChain* getLodChain() const { return lods.get(); }
+    const std::shared_ptr<Texture>& getAlbedoMap() const { return albedoMap; }
+    uint64_t getVersion() const { return version; }
 
     glm::vec3 position;
     glm::vec3 velocity;
@@ -28,15 +56,36 @@ public:
     bool useGravity;
     bool isStatic;
     bool hasCollision;
+    bool batched = false;       // drawn by a StaticBatcher, not by the scene
 
     bool checkCollision(Shape& other);
 
 protected:
-    unsigned int VAO, VBO;
-    int vertexCount = 0;
+    std::shared_ptr<Mesh> mesh;     // shapes without an LOD chain
+    glm::mat4 meshTransform = glm::mat4(1.0f);     // mesh space -> unit shape space, see Model
     glm::mat4 model;
+    glm::mat3 normalMatrix;
     glm::vec3 color;
     std::vector<std::shared_ptr<Texture>> textures;
+    std::shared_ptr<Texture> albedoMap;
+    uint32_t materialFeatures = 0;
+    float uvRepeat = 1.0f;      // times the texture repeats across the shape
+    bool doubleSided = false;   // back faces are visible, so clusters are never cone-culled
+
+    std::shared_ptr<LodChain> lods;
+    int lodState[LOD_PASS_COUNT] = { -1, -1 };
+    int activeLod = 0;
+
+    const Mesh* visibleMesh = nullptr;
+    unsigned int visibleBuffer = 0;
+    size_t visibleOffset = 0;
+    int visibleCount = 0;
+
+    uint64_t version = 0;
+    void touch();
 
     void updateModelMatrix();
+    void applyTransform(Shader& shader) const;
+    void bindTextures(Shader& shader) const;
+    void drawMesh() const;
 };
\ No newline at end of file
@@ -2,17 +2,25 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <string>
+#include <memory>
 #include "Shader.h"
 
+struct BakedCubemap;
+
+// Environment drawn behind the scene. The equirectangular panorama is baked
+// once into a mipmapped RGB9E5 cubemap cached under cache/skybox; drawing is a
+// single fullscreen triangle at the far plane.
 class Skybox {
 public:
-    Skybox(const std::string& hdrPath);
+    Skybox(const std::string& panoramaPath);
     ~Skybox();
 
     void draw(const glm::mat4& view, const glm::mat4& projection);
 
 private:
-    unsigned int VAO, VBO;
-    unsigned int textureID;
-    Shader shader;
-};
\ No newline at end of file
+    unsigned int VAO;
+    unsigned int textureID = 0;
+    std::shared_ptr<Shader> shader;
+
+    bool loadCubemap(const std::string& panoramaPath, BakedCubemap& cubemap);
+};
@@ -2,12 +2,9 @@
 #include "Shape.h"
 #include <vector>
 
+// UV sphere with an LOD chain: sectors halve per level down to 8, stacks follow
 class Sphere : public Shape {
 public:
     Sphere(float radius = 1.0f, int sectorCount = 36, int stackCount = 18);
     void draw(Shader& shader) override;
-
-private:
-    unsigned int EBO;
-    int indexCount;
 };
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Mesh.h"
+#include "MeshletCuller.h"
+#include "Shader.h"
+#include "ShaderVariants.h"
+#include "Shape.h"
+
+// Merges isStatic shapes that share a material (shader features, color,
+// albedo map, sidedness) into one world-space mesh per material, drawn with
+// one glMultiDrawElements per pass. Every LOD level of every member is kept
+// and split into ranges, one per meshlet or per level, each with world
+// bounds: members still switch LOD, and ranges outside the frustum or facing
+// away are left out of the multi-draw. Batched shapes get Shape::batched and
+// should be skipped by the scene's own draw loops.
+class StaticBatcher {
+public:
+    struct Stats {
+        int batches = 0;
+        int members = 0;
+        int ranges = 0;
+        size_t bytes = 0;
+        int rebuilds = 0;
+    };
+
+    // Rebuilds when the static shapes, their transforms or their materials
+    // changed since the last call; returns true when it did
+    bool update(const std::vector<std::shared_ptr<Shape>>& shapes);
+
+    void draw(ShaderVariants& shaders, uint32_t frameFeatures, const CullView& view);
+    void drawDepth(Shader& shader, const CullView& view);
+
+    const Stats& getStats() const { return stats; }
+
+    // --no-static-batching: every shape stays unbatched
+    static bool enabled;
+
+private:
+    struct Range {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        glm::vec3 center;
+        float radius;
+        glm::vec3 coneAxis;
+        float coneCutoff;
+    };
+
+    struct Member {
+        Shape* shape;
+        std::vector<size_t> levelStart;     // ranges of level i: [levelStart[i], levelStart[i + 1])
+    };
+
+    struct Batch {
+        std::shared_ptr<Mesh> mesh;
+        glm::vec3 color;
+        uint32_t materialFeatures;
+        std::shared_ptr<Texture> albedoMap;
+        bool doubleSided;
+        std::vector<Member> members;
+        std::vector<Range> ranges;
+    };
+
+    // Mesh-space data read back once per source mesh
+    struct SourceData {
+        std::shared_ptr<Mesh> mesh;         // keeps the key pointer from being reused
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    std::vector<Batch> batches;
+    std::unordered_map<const Mesh*, SourceData> sources;
+    uint64_t signature = 0;
+    Stats stats;
+
+    std::vector<GLsizei> counts;
+    std::vector<const void*> offsets;
+
+    void build(const std::vector<Shape*>& statics);
+    // Read back on first use, or taken over from the previous build
+    const SourceData& sourceFor(const std::shared_ptr<Mesh>& mesh,
+                                std::unordered_map<const Mesh*, SourceData>& previous);
+    // Fills counts/offsets with the visible ranges of the batch
+    void collectRanges(const Batch& batch, const CullView& view);
+};
@@ -1,13 +1,49 @@
 #pragma once
 #include <glad/glad.h>
+#include <memory>
 #include <string>
 
+struct TextureLoadJob;
+struct TextureArray;
+
+// Sampler and storage settings; part of the TextureManager cache key
+struct TextureParams {
+    GLenum wrap = GL_REPEAT;
+    GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+    GLenum magFilter = GL_LINEAR;
+    bool srgb = false;
+
+    bool operator==(const TextureParams& other) const {
+        return wrap == other.wrap && minFilter == other.minFilter &&
+               magFilter == other.magFilter && srgb == other.srgb;
+    }
+};
+
+// Image texture loaded in the background by GTextureLoader into a layer of a
+// shared texture array. Until the pixels are on the GPU, bind() and getLayer()
+// refer to the GTextureArrays placeholder.
 class Texture {
 public:
-    unsigned int ID;
     std::string type;
     std::string path;
+    TextureParams params;
 
-    Texture(const char* path, const std::string& type);
+    Texture(const char* path, const std::string& type, const TextureParams& params = {});
+    ~Texture();
+
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    // Binds the whole array; shaders select the image with getLayer()
     void bind(int unit);
-};
\ No newline at end of file
+    int getLayer() const;
+    const TextureArray* getArray() const;
+    // Tells GTextureStreamer how large the texture appears this frame
+    void requestDetail(float worldSize, float distance);
+    bool isReady() const;
+    // GPU memory including the mip chain, 0 until uploaded
+    size_t getByteSize() const;
+
+private:
+    std::shared_ptr<TextureLoadJob> job;
+};
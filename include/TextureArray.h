@@ -0,0 +1,83 @@
+#pragma once
+#include <glad/glad.h>
+#include <memory>
+#include <vector>
+
+// Everything textures must agree on to share one GL_TEXTURE_2D_ARRAY:
+// size, mip count, storage format and sampler state.
+struct TextureArrayFormat {
+    int width = 1;
+    int height = 1;
+    int levels = 1;
+    GLenum internalFormat = GL_RGBA8;
+    bool compressed = false;
+    GLenum format = GL_RGBA;            // pixel transfer format, uncompressed only
+    GLenum wrap = GL_REPEAT;
+    GLenum minFilter = GL_LINEAR;
+    GLenum magFilter = GL_LINEAR;
+
+    bool operator==(const TextureArrayFormat& other) const {
+        return width == other.width && height == other.height && levels == other.levels &&
+               internalFormat == other.internalFormat && compressed == other.compressed &&
+               format == other.format && wrap == other.wrap &&
+               minFilter == other.minFilter && magFilter == other.magFilter;
+    }
+
+    // Bytes of one layer at the given mip level
+    size_t levelBytes(int level) const;
+};
+
+struct TextureArray {
+    unsigned int ID = 0;
+    TextureArrayFormat format;
+    int capacity = 0;
+    std::vector<bool> usedLayers;
+    int usedCount = 0;
+};
+
+struct TextureArraySlot {
+    TextureArray* array = nullptr;
+    int layer = 0;
+};
+
+// Packs textures of the same format into shared array textures so objects
+// with different images can be drawn without rebinding. An array starts with
+// one layer and doubles (copying on the GPU through a pixel buffer) until
+// kMaxLayers; after that a second array of the same format is opened.
+class TextureArrayPool {
+public:
+    static constexpr int kMaxLayers = 64;
+
+    TextureArrayPool();
+    ~TextureArrayPool();
+
+    TextureArraySlot acquire(const TextureArrayFormat& format);
+    // Layer in the shared 1x1 RGBA8 array, filled with one colour
+    TextureArraySlot acquireSolid(const unsigned char rgba[4]);
+    void release(const TextureArraySlot& slot);
+
+    // Binds only when the unit does not already hold the array (see GLState)
+    void bind(const TextureArray* array, int unit);
+    // Call after binding arrays behind the pool's back (uploads)
+    void invalidateBindings();
+
+    // 1x1 mid grey, bound while a texture is still loading
+    TextureArraySlot getPlaceholder() const { return placeholder; }
+
+    int getArrayCount() const { return (int)arrays.size(); }
+    int getLayerCount() const;
+    long long getBindsIssued() const { return bindsIssued; }
+    long long getBindsSkipped() const { return bindsSkipped; }
+
+private:
+    std::vector<std::unique_ptr<TextureArray>> arrays;
+    TextureArraySlot placeholder;
+
+    long long bindsIssued = 0;
+    long long bindsSkipped = 0;
+
+    void allocateStorage(TextureArray& array, int capacity);
+    void grow(TextureArray& array);
+};
+
+extern TextureArrayPool* GTextureArrays;
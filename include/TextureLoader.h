@@ -0,0 +1,96 @@
+#pragma once
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ThreadPool.h"
+#include "CookedTexture.h"
+#include "TextureArray.h"
+#include "Texture.h"
+
+// One texture on its way from disk to the GPU. Workers fill in the decoded
+// pixels; everything else is touched on the main thread only.
+struct TextureLoadJob {
+    std::string path;
+    TextureParams params;
+    TextureArraySlot slot;          // what bind() samples
+    TextureArraySlot uploadSlot;    // receives the upload in flight, replaces slot when it completes
+    std::atomic<bool> cancelled{false};
+
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0, channels = 0;
+
+    // Set instead of pixels when a current .ctex was found next to the source
+    std::unique_ptr<CookedTexture> cooked;
+    GLenum compressedFormat = 0;
+
+    // Streaming state of cooked textures; levels index the full chain.
+    // mipCount stays 0 for textures that cannot stream.
+    int mipCount = 0;
+    int baseWidth = 0, baseHeight = 0;
+    int blockBytes = 0;
+    int maxLoadSize = 0;            // largest side the worker reads, 0 for all
+    int residentMip = -1;           // finest level on the GPU
+    int loadingMip = -1;            // level being brought in, -1 when idle
+    int requestedMip = 0;           // finest level wanted by the last frame that used it
+    long long lastUsedFrame = -1;
+
+    int rowsUploaded = 0;
+    int mipsUploaded = 0;
+    bool done = false;
+    size_t residentBytes = 0;
+};
+
+// Decodes images on a worker pool and streams them into their textures through
+// pixel buffer objects, a few rows at a time under a per-frame byte budget.
+// Cooked block-compressed files are preferred over the source image and go up
+// one mip level at a time with their precomputed chain.
+// Every texture lands in a layer of a GTextureArrays array matching its size
+// and format. Until a job is done, sample the pool's placeholder instead.
+class TextureLoader {
+public:
+    explicit TextureLoader(size_t uploadBudgetBytes = 4 * 1024 * 1024);
+    ~TextureLoader();
+
+    // maxSize > 0 loads a cooked texture from the first level no larger than it
+    std::shared_ptr<TextureLoadJob> request(const std::string& path, const TextureParams& params, int maxSize = 0);
+    // Reloads a done cooked texture starting at another level; the current
+    // levels stay bound until the new set is uploaded
+    void requestMips(const std::shared_ptr<TextureLoadJob>& job, int firstMip);
+
+    // Main thread, once per frame
+    void update();
+    // Blocks until every requested texture is uploaded
+    void finishAll();
+
+    size_t getPendingCount() const { return (size_t)inFlight.load() + uploads.size(); }
+    size_t getFrameUploadBytes() const { return frameUploadBytes; }
+
+private:
+    std::unique_ptr<ThreadPool> pool;
+
+    std::mutex mutex;
+    std::condition_variable decodedReady;
+    std::vector<std::shared_ptr<TextureLoadJob>> decoded;
+    std::atomic<int> inFlight{0};
+
+    std::deque<std::shared_ptr<TextureLoadJob>> uploads;
+
+    size_t uploadBudget;
+    size_t frameUploadBytes = 0;
+    unsigned int pbos[2] = { 0, 0 };
+    int nextPbo = 0;
+
+    void submit(const std::shared_ptr<TextureLoadJob>& job);
+    void collectDecoded();
+    void uploadPending(bool drain);
+    size_t uploadRows(TextureLoadJob& job, size_t byteBudget);
+    size_t uploadCookedMip(TextureLoadJob& job);
+    void complete(TextureLoadJob& job);
+};
+
+extern TextureLoader* GTextureLoader;
@@ -0,0 +1,32 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Texture.h"
+
+// Hands out shared textures keyed by canonical path, type and TextureParams.
+// Entries are weak: a texture is freed as soon as the last shape drops it,
+// and the next request for it loads it again.
+class TextureManager {
+public:
+    struct Stats {
+        int hits = 0;
+        int misses = 0;
+        int residentTextures = 0;
+        size_t residentBytes = 0;
+    };
+
+    std::shared_ptr<Texture> load(const std::string& path, const std::string& type,
+                                  const TextureParams& params = {});
+
+    // Drops expired entries and recounts what is still alive
+    const Stats& getStats();
+
+private:
+    std::unordered_map<std::string, std::weak_ptr<Texture>> entries;
+    Stats stats;
+
+    static std::string makeKey(const std::string& path, const std::string& type, const TextureParams& params);
+};
+
+extern TextureManager* GTextureManager;
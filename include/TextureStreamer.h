@@ -0,0 +1,55 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+struct TextureLoadJob;
+
+// Decides which mip levels of cooked textures stay on the GPU. Textures start
+// at a small level; each frame the scene reports how large every texture
+// appears on screen, and the streamer asks GTextureLoader for finer levels
+// while the total stays under the budget. When it would not, the least
+// recently used textures are dropped back to their starting level first.
+class TextureStreamer {
+public:
+    struct Stats {
+        int streamedTextures = 0;
+        size_t residentBytes = 0;       // levels on the GPU now
+        size_t requestedBytes = 0;      // levels the last frame asked for
+        size_t budgetBytes = 0;
+        long long streamIns = 0;
+        long long streamOuts = 0;
+        int loading = 0;
+    };
+
+    explicit TextureStreamer(size_t budgetBytes = 256 * 1024 * 1024, int initialSize = 64);
+
+    // Largest side of the level a texture is first loaded with
+    int getInitialSize() const { return initialSize; }
+
+    void track(const std::shared_ptr<TextureLoadJob>& job);
+
+    // Before the scene is drawn: sets the pixels-per-unit scale for requests
+    void beginFrame(const glm::mat4& projection, int viewportHeight);
+    // worldSize: extent covered by one repeat of the texture, distance: from the eye
+    void requestDetail(TextureLoadJob& job, float worldSize, float distance);
+    // After the scene is drawn: issues loads and evictions
+    void update();
+
+    const Stats& getStats();
+
+private:
+    std::vector<std::weak_ptr<TextureLoadJob>> jobs;
+    size_t budget;
+    int initialSize;
+    int maxLoadsPerFrame = 2;
+
+    long long frame = 0;
+    float pixelsPerUnit = 1.0f;
+    Stats stats;
+
+    int startMip(const TextureLoadJob& job) const;
+    std::shared_ptr<TextureLoadJob> findVictim();
+};
+
+extern TextureStreamer* GTextureStreamer;
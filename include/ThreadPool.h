@@ -0,0 +1,29 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining a FIFO of jobs. Jobs still queued when
+// the pool is destroyed are dropped; running ones are joined.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount, std::string name = "Worker");
+    ~ThreadPool();
+
+    void submit(std::function<void()> job);
+    int getThreadCount() const { return (int)workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::string name;
+
+    void workerLoop();
+};
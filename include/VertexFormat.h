@@ -0,0 +1,69 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Storage for each vertex attribute. Every format feeds the same shader
+// inputs (vec3 aPos, vec3 aNormal, vec2 aTexCoords): GL converts packed
+// integers and halves to floats, and quantized positions are mapped back
+// by a per-mesh matrix folded into the model matrix.
+enum class PositionEncoding { FLOAT32, HALF, SNORM16 };
+enum class NormalEncoding   { FLOAT32, SNORM_10_10_10_2 };
+enum class TexCoordEncoding { FLOAT32, HALF };
+
+struct VertexAttribute {
+    GLuint location;
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    unsigned int offset;
+    unsigned int size;          // bytes, padded to 4
+};
+
+// One declarative description per layout; offsets, stride, packing and the
+// glVertexAttribPointer calls all follow from the three encodings.
+class VertexFormat {
+public:
+    VertexFormat(PositionEncoding position, NormalEncoding normal, TexCoordEncoding texCoord);
+
+    // 32 bytes: float position, normal, uv
+    static const VertexFormat& full();
+    // 16 bytes: snorm16 position, 10:10:10:2 normal, half uv
+    static const VertexFormat& compact();
+    // Format MeshBuilder uses unless told otherwise; --full-vertices picks full()
+    static const VertexFormat& getDefault();
+    static bool compactByDefault;
+
+    unsigned int getStride() const { return stride; }
+    const std::vector<VertexAttribute>& getAttributes() const { return attributes; }
+    bool isQuantized() const { return position != PositionEncoding::FLOAT32; }
+    // Identifies the layout in cache files
+    uint32_t getKey() const { return (uint32_t)position | ((uint32_t)normal << 4) | ((uint32_t)texCoord << 8); }
+
+    // Packs interleaved pos(3), normal(3), uv(2) floats. dequantize maps the
+    // stored position back to mesh space and must be applied before model.
+    std::vector<uint8_t> pack(const std::vector<float>& vertices, glm::mat4& dequantize) const;
+    // Inverse of pack, back to mesh-space floats (lossy for quantized formats)
+    std::vector<float> unpack(const uint8_t* packed, size_t vertexCount, const glm::mat4& dequantize) const;
+
+    // Sets up attributes for the currently bound VAO and GL_ARRAY_BUFFER
+    void apply() const;
+
+    // Position-only stream for depth passes: the same position bits as the
+    // interleaved buffer (so invariant depth matches exactly). 16-bit positions
+    // keep their padding to 8 bytes, as a 6-byte stride is a slow fetch path.
+    unsigned int getPositionStride() const;
+    std::vector<uint8_t> extractPositions(const std::vector<uint8_t>& packed) const;
+    void applyPositions() const;
+
+private:
+    PositionEncoding position;
+    NormalEncoding normal;
+    TexCoordEncoding texCoord;
+    std::vector<VertexAttribute> attributes;
+    unsigned int stride = 0;
+};
+
+uint16_t packHalf(float value);
+float unpackHalf(uint16_t value);
@@ -0,0 +1,357 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Principal axis of the block's colours (power iteration on the covariance
+// matrix). Both BC1 and BC7 place their endpoints along it.
+template <int N>
+static void principalAxis(const float (*pixels)[4], float mean[N], float axis[N]) {
+    for (int c = 0; c < N; c++) {
+        mean[c] = 0.0f;
+        for (int i = 0; i < 16; i++) mean[c] += pixels[i][c];
+        mean[c] /= 16.0f;
+    }
+
+    float cov[N][N] = {};
+    for (int i = 0; i < 16; i++) {
+        for (int a = 0; a < N; a++)
+            for (int b = 0; b < N; b++)
+                cov[a][b] += (pixels[i][a] - mean[a]) * (pixels[i][b] - mean[b]);
+    }
+
+    for (int c = 0; c < N; c++) axis[c] = 1.0f;
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[N] = {};
+        for (int a = 0; a < N; a++)
+            for (int b = 0; b < N; b++)
+                next[a] += cov[a][b] * axis[b];
+
+        float length = 0.0f;
+        for (int c = 0; c < N; c++) length += next[c] * next[c];
+        length = std::sqrt(length);
+        if (length < 1e-6f) break;
+
+        for (int c = 0; c < N; c++) axis[c] = next[c] / length;
+    }
+}
+
+// Endpoints along the axis, pulled in slightly so the extremes land between palette entries
+template <int N>
+static void axisEndpoints(const float (*pixels)[4], float start[N], float end[N]) {
+    float mean[N], axis[N];
+    principalAxis<N>(pixels, mean, axis);
+
+    float minT = 1e30f, maxT = -1e30f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < N; c++) t += (pixels[i][c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    float inset = (maxT - minT) / 32.0f;
+    minT += inset;
+    maxT -= inset;
+
+    for (int c = 0; c < N; c++) {
+        start[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        end[c]   = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+    }
+}
+
+// Least-squares endpoints for fixed indices: pixel i is weights[i] * a + (1 - weights[i]) * b
+template <int N>
+static bool refitEndpoints(const float (*pixels)[4], const float* weights, float a[N], float b[N]) {
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[N] = {}, bx[N] = {};
+
+    for (int i = 0; i < 16; i++) {
+        float wa = weights[i];
+        float wb = 1.0f - wa;
+        aa += wa * wa;
+        bb += wb * wb;
+        ab += wa * wb;
+        for (int c = 0; c < N; c++) {
+            ax[c] += wa * pixels[i][c];
+            bx[c] += wb * pixels[i][c];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f)
+        return false;
+
+    for (int c = 0; c < N; c++) {
+        a[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+        b[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+static void toFloatPixels(const uint8_t* rgba, float pixels[16][4]) {
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 4; c++)
+            pixels[i][c] = rgba[i * 4 + c];
+}
+
+// ---------------------------------------------------------------- BC1
+
+static uint16_t packRGB565(const float* rgb) {
+    int r = std::clamp((int)(rgb[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+    int g = std::clamp((int)(rgb[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+    int b = std::clamp((int)(rgb[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpackRGB565(uint16_t color, float* rgb) {
+    int r = (color >> 11) & 31;
+    int g = (color >> 5) & 63;
+    int b = color & 31;
+    rgb[0] = (float)((r << 3) | (r >> 2));
+    rgb[1] = (float)((g << 2) | (g >> 4));
+    rgb[2] = (float)((b << 3) | (b >> 2));
+}
+
+// Picks indices for two quantized endpoints; returns the squared error
+static float fitBC1(const float pixels[16][4], uint16_t& c0, uint16_t& c1, uint32_t& indices) {
+    if (c0 < c1) std::swap(c0, c1);
+
+    float palette[4][3];
+    unpackRGB565(c0, palette[0]);
+    unpackRGB565(c1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+        palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+    // Equal endpoints select 3-colour mode; index 0 is still exact
+    int paletteSize = (c0 == c1) ? 1 : 4;
+
+    float error = 0.0f;
+    indices = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0;
+        float bestDistance = 1e30f;
+        for (int p = 0; p < paletteSize; p++) {
+            float distance = 0.0f;
+            for (int c = 0; c < 3; c++) {
+                float d = pixels[i][c] - palette[p][c];
+                distance += d * d;
+            }
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = p;
+            }
+        }
+        indices |= (uint32_t)best << (i * 2);
+        error += bestDistance;
+    }
+    return error;
+}
+
+void encodeBlockBC1(const uint8_t* rgba, uint8_t* out) {
+    float pixels[16][4];
+    toFloatPixels(rgba, pixels);
+
+    float start[3], end[3];
+    axisEndpoints<3>(pixels, start, end);
+
+    uint16_t bestC0 = packRGB565(start), bestC1 = packRGB565(end);
+    uint32_t bestIndices;
+    float bestError = fitBC1(pixels, bestC0, bestC1, bestIndices);
+
+    static const float kIndexWeight[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    for (int iteration = 0; iteration < 2 && bestC0 != bestC1; iteration++) {
+        float weights[16];
+        for (int i = 0; i < 16; i++)
+            weights[i] = kIndexWeight[(bestIndices >> (i * 2)) & 3];
+
+        float a[3], b[3];
+        if (!refitEndpoints<3>(pixels, weights, a, b))
+            break;
+
+        uint16_t c0 = packRGB565(a), c1 = packRGB565(b);
+        uint32_t indices;
+        float error = fitBC1(pixels, c0, c1, indices);
+        if (error >= bestError)
+            break;
+
+        bestC0 = c0;
+        bestC1 = c1;
+        bestIndices = indices;
+        bestError = error;
+    }
+
+    out[0] = (uint8_t)(bestC0 & 0xFF);
+    out[1] = (uint8_t)(bestC0 >> 8);
+    out[2] = (uint8_t)(bestC1 & 0xFF);
+    out[3] = (uint8_t)(bestC1 >> 8);
+    std::memcpy(out + 4, &bestIndices, 4);
+}
+
+// ---------------------------------------------------------------- BC4 / BC5
+
+void encodeBlockBC4(const uint8_t* values, uint8_t* out) {
+    uint8_t maxValue = *std::max_element(values, values + 16);
+    uint8_t minValue = *std::min_element(values, values + 16);
+
+    out[0] = maxValue;
+    out[1] = minValue;
+
+    // a0 > a1: eight-value mode, six interpolated steps between max and min
+    float palette[8];
+    palette[0] = maxValue;
+    palette[1] = minValue;
+    for (int k = 1; k <= 6; k++)
+        palette[k + 1] = ((7 - k) * maxValue + k * minValue) / 7.0f;
+
+    uint64_t indices = 0;
+    if (maxValue != minValue) {
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            float bestDistance = 1e30f;
+            for (int p = 0; p < 8; p++) {
+                float distance = std::fabs(values[i] - palette[p]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (i * 3);
+        }
+    }
+
+    for (int byte = 0; byte < 6; byte++)
+        out[2 + byte] = (uint8_t)(indices >> (byte * 8));
+}
+
+void encodeBlockBC5(const uint8_t* red, const uint8_t* green, uint8_t* out) {
+    encodeBlockBC4(red, out);
+    encodeBlockBC4(green, out + 8);
+}
+
+// ---------------------------------------------------------------- BC7 mode 6
+
+static const int kBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BC7Endpoint {
+    int q[4];   // 7-bit channels
+    int p;      // shared low bit
+    int value(int channel) const { return (q[channel] << 1) | p; }
+};
+
+static BC7Endpoint quantizeBC7(const float* color) {
+    BC7Endpoint best{};
+    float bestError = 1e30f;
+
+    for (int p = 0; p < 2; p++) {
+        BC7Endpoint endpoint{};
+        endpoint.p = p;
+        float error = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            endpoint.q[c] = std::clamp((int)std::lround((color[c] - p) / 2.0f), 0, 127);
+            float d = endpoint.value(c) - color[c];
+            error += d * d;
+        }
+        if (error < bestError) {
+            bestError = error;
+            best = endpoint;
+        }
+    }
+    return best;
+}
+
+static float fitBC7(const float pixels[16][4], const BC7Endpoint& e0, const BC7Endpoint& e1, int indices[16]) {
+    float palette[16][4];
+    for (int i = 0; i < 16; i++) {
+        int w = kBC7Weights4[i];
+        for (int c = 0; c < 4; c++)
+            palette[i][c] = (float)(((64 - w) * e0.value(c) + w * e1.value(c) + 32) >> 6);
+    }
+
+    float error = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        int best = 0;
+        float bestDistance = 1e30f;
+        for (int p = 0; p < 16; p++) {
+            float distance = 0.0f;
+            for (int c = 0; c < 4; c++) {
+                float d = pixels[i][c] - palette[p][c];
+                distance += d * d;
+            }
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = p;
+            }
+        }
+        indices[i] = best;
+        error += bestDistance;
+    }
+    return error;
+}
+
+struct BitWriter {
+    uint8_t* out;
+    int position = 0;
+
+    void write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; i++, position++) {
+            if (value & (1u << i))
+                out[position >> 3] |= (uint8_t)(1u << (position & 7));
+        }
+    }
+};
+
+void encodeBlockBC7(const uint8_t* rgba, uint8_t* out) {
+    float pixels[16][4];
+    toFloatPixels(rgba, pixels);
+
+    float start[4], end[4];
+    axisEndpoints<4>(pixels, start, end);
+
+    BC7Endpoint e0 = quantizeBC7(start), e1 = quantizeBC7(end);
+    int indices[16];
+    float bestError = fitBC7(pixels, e0, e1, indices);
+
+    for (int iteration = 0; iteration < 2; iteration++) {
+        // Index i weights endpoint 1 by kBC7Weights4[i] / 64, so endpoint 0 gets the rest
+        float weights[16];
+        for (int i = 0; i < 16; i++)
+            weights[i] = 1.0f - kBC7Weights4[indices[i]] / 64.0f;
+
+        float a[4], b[4];
+        if (!refitEndpoints<4>(pixels, weights, a, b))
+            break;
+
+        BC7Endpoint r0 = quantizeBC7(a), r1 = quantizeBC7(b);
+        int refined[16];
+        float error = fitBC7(pixels, r0, r1, refined);
+        if (error >= bestError)
+            break;
+
+        e0 = r0;
+        e1 = r1;
+        std::memcpy(indices, refined, sizeof(indices));
+        bestError = error;
+    }
+
+    // The anchor (pixel 0) index is stored without its top bit
+    if (indices[0] & 8) {
+        std::swap(e0, e1);
+        for (int i = 0; i < 16; i++)
+            indices[i] = 15 - indices[i];
+    }
+
+    std::memset(out, 0, BC7_BLOCK_BYTES);
+    BitWriter writer{ out };
+    writer.write(1u << 6, 7);   // mode 6
+    for (int c = 0; c < 4; c++) {
+        writer.write(e0.q[c], 7);
+        writer.write(e1.q[c], 7);
+    }
+    writer.write(e0.p, 1);
+    writer.write(e1.p, 1);
+    writer.write(indices[0], 3);
+    for (int i = 1; i < 16; i++)
+        writer.write(indices[i], 4);
+}
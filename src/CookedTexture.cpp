@@ -0,0 +1,144 @@
+#include "CookedTexture.h"
+#include "BlockCompression.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+static const uint32_t kCookedMagic   = 0x58544345; // "ECTX"
+static const uint32_t kCookedVersion = 1;
+
+struct CookedHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+};
+
+static const uint32_t kFlagSrgb = 1;
+
+size_t CookedTexture::getByteSize() const {
+    size_t total = 0;
+    for (const auto& mip : mips) total += mip.data.size();
+    return total;
+}
+
+const char* cookedFormatName(CookedFormat format) {
+    switch (format) {
+        case CookedFormat::BC1: return "BC1";
+        case CookedFormat::BC4: return "BC4";
+        case CookedFormat::BC5: return "BC5";
+        case CookedFormat::BC7: return "BC7";
+    }
+    return "?";
+}
+
+int cookedBlockBytes(CookedFormat format) {
+    switch (format) {
+        case CookedFormat::BC1: return BC1_BLOCK_BYTES;
+        case CookedFormat::BC4: return BC4_BLOCK_BYTES;
+        case CookedFormat::BC5: return BC5_BLOCK_BYTES;
+        case CookedFormat::BC7: return BC7_BLOCK_BYTES;
+    }
+    return 0;
+}
+
+std::string cookedPathFor(const std::string& sourcePath) {
+    return std::filesystem::path(sourcePath).replace_extension(".ctex").string();
+}
+
+bool isCookedUpToDate(const std::string& sourcePath, const std::string& cookedPath) {
+    std::error_code error;
+    auto cookedTime = std::filesystem::last_write_time(cookedPath, error);
+    if (error) return false;
+
+    // A cooked file without its source (shipped builds) is always current
+    auto sourceTime = std::filesystem::last_write_time(sourcePath, error);
+    if (error) return true;
+
+    return cookedTime >= sourceTime;
+}
+
+bool readCookedTexture(const std::string& path, CookedTexture& texture, int maxSize) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    CookedHeader header{};
+    file.read((char*)&header, sizeof(header));
+    if (!file || header.magic != kCookedMagic || header.version != kCookedVersion) {
+        std::cout << "ERROR::COOKED_TEXTURE:: Bad header in " << path << std::endl;
+        return false;
+    }
+
+    texture.format = (CookedFormat)header.format;
+    texture.srgb = (header.flags & kFlagSrgb) != 0;
+    int blockBytes = cookedBlockBytes(texture.format);
+    if (blockBytes == 0 || header.mipCount == 0 || header.mipCount > 32) {
+        std::cout << "ERROR::COOKED_TEXTURE:: Unsupported format in " << path << std::endl;
+        return false;
+    }
+
+    texture.baseWidth = (int)header.width;
+    texture.baseHeight = (int)header.height;
+    texture.mipCount = (int)header.mipCount;
+    texture.firstMip = 0;
+    texture.mips.clear();
+
+    int width = texture.baseWidth, height = texture.baseHeight;
+    for (int level = 0; level < texture.mipCount; level++) {
+        size_t size = (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+
+        // Always keep the last level so a texture never ends up empty
+        bool skip = maxSize > 0 && std::max(width, height) > maxSize && level + 1 < texture.mipCount;
+        if (skip) {
+            file.seekg((std::streamoff)size, std::ios::cur);
+            texture.firstMip = level + 1;
+        } else {
+            CookedMip mip;
+            mip.width = width;
+            mip.height = height;
+            mip.data.resize(size);
+            file.read((char*)mip.data.data(), size);
+            texture.mips.push_back(std::move(mip));
+        }
+
+        width  = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+
+    if (!file) {
+        std::cout << "ERROR::COOKED_TEXTURE:: Truncated file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool writeCookedTexture(const std::string& path, const CookedTexture& texture) {
+    if (texture.mips.empty())
+        return false;
+
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "ERROR::COOKED_TEXTURE:: Cannot write " << path << std::endl;
+        return false;
+    }
+
+    CookedHeader header{};
+    header.magic    = kCookedMagic;
+    header.version  = kCookedVersion;
+    header.format   = (uint32_t)texture.format;
+    header.flags    = texture.srgb ? kFlagSrgb : 0;
+    header.width    = (uint32_t)texture.mips[0].width;
+    header.height   = (uint32_t)texture.mips[0].height;
+    header.mipCount = (uint32_t)texture.mips.size();
+    file.write((const char*)&header, sizeof(header));
+
+    for (const auto& mip : texture.mips)
+        file.write((const char*)mip.data.data(), mip.data.size());
+
+    return (bool)file;
+}
@@ -1,4 +1,5 @@
 #include "Cube.h"
+#include "MeshBuilder.h"
 
 Cube::Cube() {
     // Tablica z danymi wierzchołków (pozycja, normalna (kierunek powierzchni), współrzędne tekstury)
@@ -45,66 +46,23 @@ Cube::Cube() {
          0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
         -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
     };
-    // 6 scian x 2 trojkaty na sciane x 3 wierzcholki na trojkat = 36 wierzcholkow
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // atrybuty wierzchołków
-    // pozycja
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // normalna
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // współrzędne UV
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // 6 scian x 2 trojkaty na sciane x 3 wierzcholki na trojkat = 36 wierzcholkow,
+    // po deduplikacji zostaje 24; wszystkie kostki dziela jeden mesh
+    static std::weak_ptr<Mesh> shared;
+    mesh = shared.lock();
+    if (!mesh) {
+        MeshBuilder builder;
+        builder.addTriangleSoup(vertices, 36);
+        mesh = builder.build();
+        shared = mesh;
+    }
 }
 
 void Cube::draw(Shader& shader) {
-    shader.setMat4("model", model);
+    applyTransform(shader);
 
     shader.setVec3("objectColor", color);
-    shader.setBool("material.hasAlbedo", false);
-    shader.setBool("material.hasNormal", false);
-    shader.setBool("material.hasMetallic", false);
-    shader.setBool("material.hasRoughness", false);
-    shader.setBool("material.hasAO", false);
-
-    // Sprawdzamy jakie tekstury sa przypisane do obiektu
-    for(unsigned int i = 0; i < textures.size(); i++) {
-        std::string name = textures[i]->type;
+    bindTextures(shader);
 
-        if(name == "texture_albedo") {
-            shader.setInt("material.albedoMap", i);
-            shader.setBool("material.hasAlbedo", true);
-        } else if(name == "texture_normal") {
-            shader.setInt("material.normalMap", i);
-            shader.setBool("material.hasNormal", true);
-        } else if(name == "texture_metallic") {
-            shader.setInt("material.metallicMap", i);
-            shader.setBool("material.hasMetallic", true);
-        } else if(name == "texture_roughness") {
-            shader.setInt("material.roughnessMap", i);
-            shader.setBool("material.hasRoughness", true);
-        } else if(name == "texture_ao") {
-            shader.setInt("material.aoMap", i);
-            shader.setBool("material.hasAO", true);
-        }
-
-        textures[i]->bind(i);
-    }
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    drawMesh();
 }
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "CubemapBake.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+static const uint32_t kCubemapMagic   = 0x42554345; // "ECUB"
+static const uint32_t kCubemapVersion = 1;
+
+struct CubemapHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t faceSize;
+    uint32_t mipCount;
+};
+
+size_t BakedCubemap::getByteSize() const {
+    size_t total = 0;
+    for (const auto& level : levels) total += level.size() * sizeof(uint32_t);
+    return total;
+}
+
+// EXT_texture_shared_exponent: 9-bit mantissas sharing one 5-bit exponent
+uint32_t packRGB9E5(float r, float g, float b) {
+    const int mantissaBits = 9;
+    const int expBias = 15;
+    const int maxExp = 31;
+    const float sharedMax = (float)((1 << mantissaBits) - 1) / (1 << mantissaBits) * (float)(1 << (maxExp - expBias));
+
+    r = std::clamp(std::isfinite(r) ? r : 0.0f, 0.0f, sharedMax);
+    g = std::clamp(std::isfinite(g) ? g : 0.0f, 0.0f, sharedMax);
+    b = std::clamp(std::isfinite(b) ? b : 0.0f, 0.0f, sharedMax);
+
+    float maxChannel = std::max(r, std::max(g, b));
+    int exponent = std::max(-expBias - 1, (int)std::floor(std::log2(std::max(maxChannel, 1e-30f)))) + 1 + expBias;
+    double denom = std::pow(2.0, exponent - expBias - mantissaBits);
+
+    // Rounding can overflow the mantissa; bump the exponent once if so
+    if ((int)std::floor(maxChannel / denom + 0.5) == (1 << mantissaBits)) {
+        exponent++;
+        denom *= 2.0;
+    }
+
+    uint32_t rm = (uint32_t)std::floor(r / denom + 0.5);
+    uint32_t gm = (uint32_t)std::floor(g / denom + 0.5);
+    uint32_t bm = (uint32_t)std::floor(b / denom + 0.5);
+    return rm | (gm << 9) | (bm << 18) | ((uint32_t)exponent << 27);
+}
+
+// Direction through texel (s, t) in [-1, 1] of a face, GL cubemap conventions
+static void faceDirection(int face, float s, float t, float out[3]) {
+    switch (face) {
+        case 0: out[0] =  1; out[1] = -t; out[2] = -s; break;  // +X
+        case 1: out[0] = -1; out[1] = -t; out[2] =  s; break;  // -X
+        case 2: out[0] =  s; out[1] =  1; out[2] =  t; break;  // +Y
+        case 3: out[0] =  s; out[1] = -1; out[2] = -t; break;  // -Y
+        case 4: out[0] =  s; out[1] = -t; out[2] =  1; break;  // +Z
+        default: out[0] = -s; out[1] = -t; out[2] = -1; break; // -Z
+    }
+}
+
+// Bilinear sample of the panorama, wrapping horizontally and clamping at the poles
+static void samplePanorama(const float* rgb, int width, int height, int channels, float u, float v, float out[3]) {
+    float x = u * width - 0.5f;
+    float y = v * height - 0.5f;
+    int x0 = (int)std::floor(x), y0 = (int)std::floor(y);
+    float fx = x - x0, fy = y - y0;
+
+    auto texel = [&](int tx, int ty, int c) {
+        tx = ((tx % width) + width) % width;
+        ty = std::clamp(ty, 0, height - 1);
+        return rgb[((size_t)ty * width + tx) * channels + std::min(c, channels - 1)];
+    };
+
+    for (int c = 0; c < 3; c++) {
+        float top = texel(x0, y0, c) * (1 - fx) + texel(x0 + 1, y0, c) * fx;
+        float bottom = texel(x0, y0 + 1, c) * (1 - fx) + texel(x0 + 1, y0 + 1, c) * fx;
+        out[c] = top * (1 - fy) + bottom * fy;
+    }
+}
+
+BakedCubemap bakeEquirectCubemap(const float* rgb, int width, int height, int channels, int faceSize) {
+    const float kPi = 3.14159265358979f;
+
+    BakedCubemap cubemap;
+    cubemap.faceSize = faceSize;
+    cubemap.mipCount = 1;
+    while (faceSize >> cubemap.mipCount) cubemap.mipCount++;
+
+    // Base level in float; the smaller levels are box filtered from it
+    std::vector<std::vector<float>> faces(6, std::vector<float>((size_t)faceSize * faceSize * 3));
+
+    auto bakeFace = [&](int face) {
+        for (int y = 0; y < faceSize; y++) {
+            for (int x = 0; x < faceSize; x++) {
+                float dir[3];
+                faceDirection(face, 2.0f * (x + 0.5f) / faceSize - 1.0f, 2.0f * (y + 0.5f) / faceSize - 1.0f, dir);
+                float length = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+
+                // Same mapping the old per-pixel skybox shader used
+                float u = std::atan2(dir[2], dir[0]) / (2.0f * kPi) + 0.5f;
+                float v = std::asin(dir[1] / length) / kPi + 0.5f;
+                samplePanorama(rgb, width, height, channels, u, v, &faces[face][((size_t)y * faceSize + x) * 3]);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int face = 0; face < 6; face++)
+        threads.emplace_back(bakeFace, face);
+    for (auto& thread : threads)
+        thread.join();
+
+    cubemap.levels.resize((size_t)cubemap.mipCount * 6);
+    int size = faceSize;
+    for (int mip = 0; mip < cubemap.mipCount; mip++) {
+        for (int face = 0; face < 6; face++) {
+            std::vector<float>& src = faces[face];
+
+            if (mip > 0) {
+                int srcSize = size * 2;
+                std::vector<float> dst((size_t)size * size * 3);
+                for (int y = 0; y < size; y++)
+                    for (int x = 0; x < size; x++)
+                        for (int c = 0; c < 3; c++) {
+                            auto at = [&](int sx, int sy) { return src[((size_t)sy * srcSize + sx) * 3 + c]; };
+                            dst[((size_t)y * size + x) * 3 + c] = 0.25f * (at(2 * x, 2 * y) + at(2 * x + 1, 2 * y) +
+                                                                          at(2 * x, 2 * y + 1) + at(2 * x + 1, 2 * y + 1));
+                        }
+                src.swap(dst);
+            }
+
+            std::vector<uint32_t>& packed = cubemap.levels[(size_t)mip * 6 + face];
+            packed.resize((size_t)size * size);
+            for (size_t i = 0; i < packed.size(); i++)
+                packed[i] = packRGB9E5(src[i * 3], src[i * 3 + 1], src[i * 3 + 2]);
+        }
+        size = std::max(1, size / 2);
+    }
+    return cubemap;
+}
+
+std::string bakedCubemapPathFor(const std::string& sourcePath) {
+    std::filesystem::path source(sourcePath);
+    return (std::filesystem::path("cache/skybox") / source.stem()).string() + ".cube";
+}
+
+bool readBakedCubemap(const std::string& path, BakedCubemap& cubemap) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    CubemapHeader header{};
+    file.read((char*)&header, sizeof(header));
+    if (!file || header.magic != kCubemapMagic || header.version != kCubemapVersion ||
+        header.faceSize == 0 || header.mipCount == 0 || header.mipCount > 16) {
+        std::cout << "ERROR::CUBEMAP:: Bad header in " << path << std::endl;
+        return false;
+    }
+
+    cubemap.faceSize = (int)header.faceSize;
+    cubemap.mipCount = (int)header.mipCount;
+    cubemap.levels.resize((size_t)cubemap.mipCount * 6);
+
+    int size = cubemap.faceSize;
+    for (int mip = 0; mip < cubemap.mipCount; mip++) {
+        for (int face = 0; face < 6; face++) {
+            std::vector<uint32_t>& level = cubemap.levels[(size_t)mip * 6 + face];
+            level.resize((size_t)size * size);
+            file.read((char*)level.data(), level.size() * sizeof(uint32_t));
+        }
+        size = std::max(1, size / 2);
+    }
+
+    if (!file) {
+        std::cout << "ERROR::CUBEMAP:: Truncated file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool writeBakedCubemap(const std::string& path, const BakedCubemap& cubemap) {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "ERROR::CUBEMAP:: Cannot write " << path << std::endl;
+        return false;
+    }
+
+    CubemapHeader header{};
+    header.magic    = kCubemapMagic;
+    header.version  = kCubemapVersion;
+    header.faceSize = (uint32_t)cubemap.faceSize;
+    header.mipCount = (uint32_t)cubemap.mipCount;
+    file.write((const char*)&header, sizeof(header));
+
+    for (const auto& level : cubemap.levels)
+        file.write((const char*)level.data(), level.size() * sizeof(uint32_t));
+
+    return (bool)file;
+}
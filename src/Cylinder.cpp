@@ -1,110 +1,76 @@
 #include "Cylinder.h"
+#include "MeshBuilder.h"
 #include <vector>
 #include <cmath>
+#include <string>
 
-Cylinder::Cylinder(float radius, float height, int segments) {
-    build(radius, height, segments);
-}
-
-void Cylinder::build(float radius, float height, int segments) {
+static std::shared_ptr<Mesh> buildCylinderMesh(float radius, float height, int segments) {
     std::vector<float> vertices;
+    std::vector<unsigned int> indices;
 
     float halfH = height * 0.5f;
 
-    // БІЧНА СТІНКА
-    for (int i = 0; i < segments; i++) {
-        float a0 = (float)i / segments * 2.0f * M_PI;
-        float a1 = (float)(i + 1) / segments * 2.0f * M_PI;
+    // БІЧНА СТІНКА: кільця знизу і зверху, останній стовпчик дублює перший заради UV-шва
+    for (int i = 0; i <= segments; i++) {
+        float a = (float)i / segments * 2.0f * M_PI;
+        float nx = cos(a);
+        float nz = sin(a);
+        float u = (float)i / segments;
 
-        float x0 = cos(a0) * radius;
-        float z0 = sin(a0) * radius;
-        float x1 = cos(a1) * radius;
-        float z1 = sin(a1) * radius;
-
-        float nx0 = cos(a0);
-        float nz0 = sin(a0);
-        float nx1 = cos(a1);
-        float nz1 = sin(a1);
-
-        // Трикутник 1
         vertices.insert(vertices.end(), {
-            x0, -halfH, z0,  nx0, 0, nz0,  (float)i/segments, 0.0f,
-            x0,  halfH, z0,  nx0, 0, nz0,  (float)i/segments, 1.0f,
-            x1,  halfH, z1,  nx1, 0, nz1,  (float)(i+1)/segments, 1.0f
-        });
-
-        // Трикутник 2
-        vertices.insert(vertices.end(), {
-            x0, -halfH, z0,  nx0, 0, nz0,  (float)i/segments, 0.0f,
-            x1,  halfH, z1,  nx1, 0, nz1,  (float)(i+1)/segments, 1.0f,
-            x1, -halfH, z1,  nx1, 0, nz1,  (float)(i+1)/segments, 0.0f
+            nx * radius, -halfH, nz * radius,  nx, 0, nz,  u, 0.0f,
+            nx * radius,  halfH, nz * radius,  nx, 0, nz,  u, 1.0f
         });
     }
-
-    // ВЕРХНЯ КРИШКА
     for (int i = 0; i < segments; i++) {
-        float a0 = (float)i / segments * 2.0f * M_PI;
-        float a1 = (float)(i + 1) / segments * 2.0f * M_PI;
-
-        float x0 = cos(a0) * radius;
-        float z0 = sin(a0) * radius;
-        float x1 = cos(a1) * radius;
-        float z1 = sin(a1) * radius;
-
-        vertices.insert(vertices.end(), {
-            0,  halfH, 0,   0,1,0,   0.5f, 0.5f,
-            x1, halfH, z1,  0,1,0,   (x1/radius+1)*0.5f, (z1/radius+1)*0.5f,
-            x0, halfH, z0,  0,1,0,   (x0/radius+1)*0.5f, (z0/radius+1)*0.5f
-        });
+        unsigned int bottom0 = i * 2, top0 = i * 2 + 1;
+        unsigned int bottom1 = i * 2 + 2, top1 = i * 2 + 3;
+        indices.insert(indices.end(), { bottom0, top0, top1, bottom0, top1, bottom1 });
     }
 
-    //  НИЖНЯ КРИШКА
-    for (int i = 0; i < segments; i++) {
-        float a0 = (float)i / segments * 2.0f * M_PI;
-        float a1 = (float)(i + 1) / segments * 2.0f * M_PI;
-
-        float x0 = cos(a0) * radius;
-        float z0 = sin(a0) * radius;
-        float x1 = cos(a1) * radius;
-        float z1 = sin(a1) * radius;
-
-        vertices.insert(vertices.end(), {
-            0, -halfH, 0,   0,-1,0,   0.5f, 0.5f,
-            x0, -halfH, z0, 0,-1,0,   (x0/radius+1)*0.5f, (z0/radius+1)*0.5f,
-            x1, -halfH, z1, 0,-1,0,   (x1/radius+1)*0.5f, (z1/radius+1)*0.5f
-        });
+    // КРИШКИ: центр + кільце, окремі вершини через іншу нормаль
+    for (int side = 0; side < 2; side++) {
+        float y = side == 0 ? halfH : -halfH;
+        float ny = side == 0 ? 1.0f : -1.0f;
+
+        unsigned int center = (unsigned int)(vertices.size() / 8);
+        vertices.insert(vertices.end(), { 0, y, 0,  0, ny, 0,  0.5f, 0.5f });
+
+        for (int i = 0; i < segments; i++) {
+            float a = (float)i / segments * 2.0f * M_PI;
+            float x = cos(a), z = sin(a);
+            vertices.insert(vertices.end(), { x * radius, y, z * radius,  0, ny, 0,  (x + 1) * 0.5f, (z + 1) * 0.5f });
+        }
+
+        for (int i = 0; i < segments; i++) {
+            unsigned int v0 = center + 1 + i;
+            unsigned int v1 = center + 1 + (i + 1) % segments;
+            // Обидві кришки дивляться назовні
+            if (side == 0)
+                indices.insert(indices.end(), { center, v1, v0 });
+            else
+                indices.insert(indices.end(), { center, v0, v1 });
+        }
     }
 
-    vertexCount = vertices.size() / 8;
-
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    // layout: pos(3), normal(3), uv(2)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    MeshBuilder builder;
+    builder.addIndexed(vertices, indices);
+    return builder.build();
+}
 
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+Cylinder::Cylinder(float radius, float height, int segments) {
+    std::string key = "cylinder:" + std::to_string(radius) + ":" + std::to_string(height) + ":" + std::to_string(segments);
+    float boundingRadius = std::sqrt(radius * radius + 0.25f * height * height);
 
-    glBindVertexArray(0);
+    lods = LodChain::get(key, segments, 8, boundingRadius, [=](int count) {
+        return buildCylinderMesh(radius, height, count);
+    });
 }
 
 void Cylinder::draw(Shader& shader) {
-    shader.setMat4("model", model);
+    applyTransform(shader);
 
-    for (int i = 0; i < textures.size(); i++)
-        textures[i]->bind(i);
+    bindTextures(shader);
 
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-    glBindVertexArray(0);
+    drawMesh();
 }
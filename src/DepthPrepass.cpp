@@ -0,0 +1,105 @@
+#include "DepthPrepass.h"
+#include "ShaderLibrary.h"
+#include "GLState.h"
+#include <iostream>
+
+// Auto mode turns the pre-pass off again only below this share of the threshold
+static const float kDisableHysteresis = 0.8f;
+
+DepthPrepass::DepthPrepass() {
+    // Same vertex shader as the lighting pass (invariant gl_Position), so GL_EQUAL matches exactly
+    shader = GShaderLibrary->load("src/lighting.vert", "src/shadow_depth.frag");
+    glGenQueries(1, &query);
+}
+
+DepthPrepass::~DepthPrepass() {
+    glDeleteQueries(1, &query);
+}
+
+void DepthPrepass::setMode(Mode newMode) {
+    mode = newMode;
+    if (mode != Mode::Auto)
+        active = (mode == Mode::On);
+}
+
+void DepthPrepass::update(int pixelCount) {
+    if (queryPending && pixelCount > 0) {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (available) {
+            GLuint samples = 0;
+            glGetQueryObjectuiv(query, GL_QUERY_RESULT, &samples);
+            queryPending = false;
+            overdraw = (float)samples / pixelCount;
+
+            if (mode == Mode::Auto) {
+                bool wasActive = active;
+                if (!active && overdraw > overdrawThreshold)
+                    active = true;
+                else if (active && overdraw < overdrawThreshold * kDisableHysteresis)
+                    active = false;
+
+                if (active != wasActive) {
+                    std::cout << "Depth pre-pass: " << (active ? "ON" : "OFF")
+                              << " (overdraw " << overdraw << ")" << std::endl;
+                }
+            }
+        }
+    }
+
+    if (mode != Mode::Auto)
+        active = (mode == Mode::On);
+}
+
+Shader& DepthPrepass::beginDepthPass(const glm::mat4& view, const glm::mat4& projection) {
+    // With the pre-pass on, the depth pass sees the same fragments the lighting pass would have shaded
+    beginQuery();
+
+    GGLState->colorMask(false);
+    GGLState->depthFunc(GL_LESS);
+    GGLState->depthMask(true);
+
+    shader->use();
+    shader->setMat4("view", view);
+    shader->setMat4("projection", projection);
+    return *shader;
+}
+
+void DepthPrepass::endDepthPass() {
+    endQuery();
+    GGLState->colorMask(true);
+}
+
+void DepthPrepass::beginShadingPass() {
+    if (active) {
+        GGLState->depthFunc(GL_EQUAL);
+        GGLState->depthMask(false);
+    } else {
+        beginQuery();
+    }
+}
+
+void DepthPrepass::endShadingPass() {
+    if (active) {
+        GGLState->depthFunc(GL_LESS);
+        GGLState->depthMask(true);
+    } else {
+        endQuery();
+    }
+}
+
+void DepthPrepass::beginQuery() {
+    if (queryPending || mode != Mode::Auto)
+        return;
+    glBeginQuery(GL_SAMPLES_PASSED, query);
+    queryRunning = true;
+}
+
+void DepthPrepass::endQuery() {
+    if (!queryRunning)
+        return;
+    glEndQuery(GL_SAMPLES_PASSED);
+    queryRunning = false;
+    queryPending = true;
+}
@@ -1,9 +1,16 @@
 #include "Engine.h"
+#include "Profiler.h"
+#include "GLExtensions.h"
+#include "ShaderCache.h"
+#include "Mesh.h"
+#include "MeshBuilder.h"
 
 #include <iostream>
 #include <algorithm>
 #include <thread>
 #include <chrono>
+#include <vector>
+#include <fstream>
 #include <glm/gtc/matrix_transform.hpp>
 
 // Глобальна камера
@@ -11,9 +18,17 @@ glm::vec3 cameraPos   = glm::vec3(0.0f, 2.0f,  6.0f);
 glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
 glm::vec3 cameraUp    = glm::vec3(0.0f, 1.0f,  0.0f);
 
+glm::ivec2   framebufferSize    = glm::ivec2(1920, 1080);
+unsigned int defaultFramebuffer = 0;
+
 // FPS counter
 static double g_fpsLastTime = 0.0;
 static int    g_fpsFrames   = 0;
+static double g_cpuTime     = 0.0;
+static int    g_fpsTargetAllocations = 0;   // pool total at the last report
+
+// Startup timing (renderer init up to the first loaded scene)
+static std::chrono::steady_clock::time_point g_startupBegin;
 
 // Manual FPS limit (0 = unlimited)
 static int targetFPS = 0;
@@ -32,6 +47,26 @@ Engine::Engine() {
 }
 
 Engine::~Engine() {
+    // Scene resources (textures, buffers) go while the context is still current
+    currentScene.reset();
+
+    // GL owners in reverse creation order; glState last, the others forget through it
+    shadowMap.reset();
+    depthShader.reset();
+    lampShader.reset();
+    gpuDrivenRenderer.reset();
+    lightingShaders.reset();
+    shaderLibrary.reset();
+    meshletCuller.reset();
+    meshImporter.reset();
+    textureStreamer.reset();
+    textureManager.reset();
+    textureLoader.reset();
+    textureArrays.reset();
+    gpuProfiler.reset();
+    renderTargetPool.reset();
+    glState.reset();
+
     glfwTerminate();
 }
 
@@ -64,6 +99,8 @@ int Engine::init(int width, int height, const char* title) {
     // VSync повністю вимкнено
     glfwSwapInterval(0);
 
+    glfwGetFramebufferSize(window, &framebufferSize.x, &framebufferSize.y);
+
     glfwSetWindowUserPointer(window, this);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
@@ -75,27 +112,103 @@ int Engine::init(int width, int height, const char* title) {
         return -1;
     }
 
-    glEnable(GL_DEPTH_TEST);
+    if (initRenderer((GLADloadproc)glfwGetProcAddress) != 0)
+        return -1;
+
+    lastFrame      = glfwGetTime();
+    g_fpsLastTime  = glfwGetTime();
+    g_fpsFrames    = 0;
+
+    return 0;
+}
+
+int Engine::initHeadless(int width, int height, int frames, const char* screenshotPath) {
+    this->width  = width;
+    this->height = height;
+    headlessFrames = frames;
+    if (screenshotPath)
+        this->screenshotPath = screenshotPath;
+
+    headless = std::make_unique<HeadlessContext>();
+    if (!headless->create())
+        return -1;
+
+    if (!gladLoadGLLoader((GLADloadproc)HeadlessContext::getProcAddress)) {
+        std::cout << "Failed to initialize GLAD\n";
+        return -1;
+    }
+
+    if (!headless->createFramebuffer(width, height))
+        return -1;
 
-    lightingShader = std::make_unique<Shader>(
+    defaultFramebuffer = headless->framebuffer;
+    framebufferSize    = glm::ivec2(width, height);
+
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << " | " << glGetString(GL_VERSION) << std::endl;
+
+    return initRenderer((GLADloadproc)HeadlessContext::getProcAddress);
+}
+
+int Engine::initRenderer(GLADloadproc loader) {
+    g_startupBegin = std::chrono::steady_clock::now();
+
+    loadGLExtensions(loader);
+
+    glState = std::make_unique<GLState>();
+    GGLState = glState.get();
+    glState->setEnabled(GL_DEPTH_TEST, true);
+
+    renderTargetPool = std::make_unique<RenderTargetPool>();
+    GRenderTargetPool = renderTargetPool.get();
+
+    gpuProfiler = std::make_unique<GpuProfiler>();
+    GGpuProfiler = gpuProfiler.get();
+
+    textureArrays = std::make_unique<TextureArrayPool>();
+    GTextureArrays = textureArrays.get();
+    textureLoader = std::make_unique<TextureLoader>();
+    GTextureLoader = textureLoader.get();
+    textureManager = std::make_unique<TextureManager>();
+    GTextureManager = textureManager.get();
+    textureStreamer = std::make_unique<TextureStreamer>(textureBudgetBytes);
+    GTextureStreamer = textureStreamer.get();
+    meshImporter = std::make_unique<MeshImporter>();
+    GMeshImporter = meshImporter.get();
+    meshletCuller = std::make_unique<MeshletCuller>();
+    GMeshletCuller = meshletCuller.get();
+
+    shaderLibrary = std::make_unique<ShaderLibrary>();
+    GShaderLibrary = shaderLibrary.get();
+
+    lightingShaders = std::make_unique<ShaderVariants>(
         PROJECT_ROOT_DIR "/src/lighting.vert",
-        PROJECT_ROOT_DIR "/src/lighting.frag"
+        PROJECT_ROOT_DIR "/src/lighting.frag",
+        std::vector<std::string>{ "HAS_ALBEDO_MAP", "ENABLE_LIGHTING", "ENABLE_SHADOWS", "GPU_DRIVEN" }
     );
-    lampShader = std::make_unique<Shader>(
+    // Queue the common lighting variants with the rest; nothing waits until first use
+    lightingShaders->get(FEATURE_LIGHTING | FEATURE_SHADOWS);
+    lightingShaders->get(FEATURE_ALBEDO_MAP | FEATURE_LIGHTING | FEATURE_SHADOWS);
+
+    if (GpuDrivenRenderer::enabled && !GLExt.gpuDriven) {
+        std::cout << "ERROR::GPU_DRIVEN:: Needs OpenGL 4.3 with buffer storage, drawing shapes one by one" << std::endl;
+    } else if (GpuDrivenRenderer::enabled) {
+        gpuDrivenRenderer = std::make_unique<GpuDrivenRenderer>();
+        GGpuDrivenRenderer = gpuDrivenRenderer.get();
+        lightingShaders->get(FEATURE_LIGHTING | FEATURE_SHADOWS | FEATURE_GPU_DRIVEN);
+        lightingShaders->get(FEATURE_ALBEDO_MAP | FEATURE_LIGHTING | FEATURE_SHADOWS | FEATURE_GPU_DRIVEN);
+    }
+
+    lampShader = GShaderLibrary->load(
         PROJECT_ROOT_DIR "/src/lighting.vert",
         PROJECT_ROOT_DIR "/src/lamp.frag"
     );
-    depthShader = std::make_unique<Shader>(
+    depthShader = GShaderLibrary->load(
         PROJECT_ROOT_DIR "/src/shadow_depth.vert",
         PROJECT_ROOT_DIR "/src/shadow_depth.frag"
     );
 
     shadowMap = std::make_unique<ShadowMap>();
 
-    lastFrame      = glfwGetTime();
-    g_fpsLastTime  = glfwGetTime();
-    g_fpsFrames    = 0;
-
     return 0;
 }
 
@@ -104,11 +217,22 @@ void Engine::setScene(std::shared_ptr<Scene> scene) {
 }
 
 void Engine::run() {
+    if (headless) {
+        runHeadless();
+        return;
+    }
+
     if (currentScene) {
         currentScene->load();
     }
+    // One wait for every program queued during init and load
+    shaderLibrary->finishAll();
+    reportStartup();
 
     while (!glfwWindowShouldClose(window)) {
+        PROFILE_SCOPE("Frame");
+
+        glfwGetFramebufferSize(window, &framebufferSize.x, &framebufferSize.y);
 
         double currentFrame = glfwGetTime();
         double rawDelta     = currentFrame - lastFrame;
@@ -119,18 +243,37 @@ void Engine::run() {
         // FPS counter
         g_fpsFrames++;
         if (currentFrame - g_fpsLastTime >= 1.0) {
-            std::cout << "FPS: " << g_fpsFrames << std::endl;
+            std::cout << "FPS: " << g_fpsFrames
+                      << " | CPU " << (g_cpuTime * 1000.0 / g_fpsFrames) << " ms"
+                      << " | " << gpuProfiler->getSummary()
+                      << " | " << renderTargetPool->getTotalAllocations() - g_fpsTargetAllocations
+                      << " render target allocations" << std::endl;
             g_fpsFrames = 0;
+            g_cpuTime = 0.0;
+            g_fpsTargetAllocations = renderTargetPool->getTotalAllocations();
             g_fpsLastTime = currentFrame;
         }
 
+        glState->beginFrame();
+        renderTargetPool->beginFrame();
+        gpuProfiler->beginFrame();
+        shaderLibrary->poll();
+        textureLoader->update();
+
         input->update(window);
         processInput();
         update();
         render();
+        textureStreamer->update();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        gpuProfiler->endFrame();
+        g_cpuTime += glfwGetTime() - currentFrame;
+
+        {
+            PROFILE_SCOPE("SwapBuffers");
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
 
         // Manual FPS limit
         if (targetFPS > 0) {
@@ -145,6 +288,202 @@ void Engine::run() {
             }
         }
     }
+
+    PROFILE_DUMP("profile_trace.json");
+}
+
+void Engine::runHeadless() {
+    if (currentScene) {
+        currentScene->load();
+    }
+    // One wait for every program queued during init and load
+    shaderLibrary->finishAll();
+    // Benchmark frames measure steady-state rendering, not texture streaming
+    textureLoader->finishAll();
+    reportStartup();
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(headlessFrames);
+
+    auto benchStart = std::chrono::steady_clock::now();
+    long long trianglesBefore = Mesh::trianglesDrawn;
+    long long vertexBytesBefore = Mesh::vertexBytesFetched;
+    long long drawCallsBefore = Mesh::drawCalls;
+    MeshletCuller::Stats clustersBefore = meshletCuller->getStats();
+    GLState::Stats stateBefore = glState->getTotals();
+    int targetAllocationsBefore = renderTargetPool->getTotalAllocations();
+    int maxFrameTargetAllocations = 0;
+
+    for (int frame = 0; frame < headlessFrames; frame++) {
+        PROFILE_SCOPE("Frame");
+        auto frameStart = std::chrono::steady_clock::now();
+
+        // Fixed step and a scripted camera: one full turn with a slow pitch sweep
+        deltaTime = 1.0f / 60.0f;
+        float t = (float)frame / headlessFrames;
+        input->yaw   = -90.0f + 360.0f * t;
+        input->pitch = -10.0f + 10.0f * sin(t * glm::radians(360.0f));
+
+        glState->beginFrame();
+        renderTargetPool->beginFrame();
+        gpuProfiler->beginFrame();
+        shaderLibrary->poll();
+        textureLoader->update();
+
+        update();
+        render();
+        textureStreamer->update();
+
+        gpuProfiler->endFrame();
+        glFlush();
+        maxFrameTargetAllocations = std::max(maxFrameTargetAllocations, renderTargetPool->getFrameAllocations());
+
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - frameStart).count());
+    }
+
+    glFinish();
+    double totalMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - benchStart).count();
+
+    if (!frameTimes.empty()) {
+        std::vector<double> sorted = frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+
+        double sum = 0.0;
+        for (double ms : sorted) sum += ms;
+
+        auto percentile = [&sorted](double p) {
+            size_t index = std::min(sorted.size() - 1, (size_t)(p * (sorted.size() - 1) + 0.5));
+            return sorted[index];
+        };
+
+        std::cout << "Headless benchmark: " << sorted.size() << " frames at "
+                  << width << "x" << height << "\n"
+                  << "  total  " << totalMs << " ms (" << (sorted.size() * 1000.0 / totalMs) << " FPS)\n"
+                  << "  frame  avg " << (sum / sorted.size()) << " ms | min " << sorted.front()
+                  << " | p50 " << percentile(0.5) << " | p95 " << percentile(0.95)
+                  << " | max " << sorted.back() << " ms\n"
+                  << "  " << gpuProfiler->getSummary() << std::endl;
+
+        std::cout << "  meshes " << (Mesh::trianglesDrawn - trianglesBefore) / (double)sorted.size()
+                  << " LOD triangles/frame, "
+                  << (Mesh::vertexBytesFetched - vertexBytesBefore) / 1024.0 / sorted.size()
+                  << " KB vertex fetch/frame, "
+                  << (Mesh::drawCalls - drawCallsBefore) / (double)sorted.size() << " draws/frame" << std::endl;
+
+        const GLState::Stats& state = glState->getTotals();
+        long long issued = state.issued - stateBefore.issued;
+        long long elided = state.elided - stateBefore.elided;
+        std::cout << "  gl state " << issued / (double)sorted.size() << " calls issued, "
+                  << elided / (double)sorted.size() << " elided/frame ("
+                  << 100.0 * elided / std::max(issued + elided, 1LL) << "% redundant)" << std::endl;
+
+        const MeshletCuller::Stats& clusters = meshletCuller->getStats();
+        long long clustersTested = clusters.clustersTested - clustersBefore.clustersTested;
+        if (clustersTested > 0) {
+            long long trianglesTested = clusters.trianglesTested - clustersBefore.trianglesTested;
+            long long trianglesVisible = clusters.trianglesVisible - clustersBefore.trianglesVisible;
+            std::cout << "  clusters " << (clusters.clustersVisible - clustersBefore.clustersVisible) / (double)sorted.size()
+                      << " of " << clustersTested / (double)sorted.size() << " visible/frame, "
+                      << 100.0 * (trianglesTested - trianglesVisible) / trianglesTested << "% triangles culled | "
+                      << (clusters.cullMs - clustersBefore.cullMs) / sorted.size() << " ms cull/frame" << std::endl;
+        }
+
+        if (gpuDrivenRenderer) {
+            const GpuDrivenRenderer::Stats& gpu = gpuDrivenRenderer->getStats();
+            double counted = std::max<long long>(gpu.countedFrames, 1);
+            std::cout << "  gpu-driven " << gpu.objects / (double)std::max<long long>(gpu.frames, 1) << " objects, "
+                      << gpu.multiDraws / (double)std::max<long long>(gpu.frames, 1) << " multi-draws/frame | "
+                      << gpu.frustumCulled / counted << " frustum-culled, " << gpu.occluded / counted
+                      << " occluded of " << gpu.tested / counted << " tested, "
+                      << gpu.trianglesVisible / counted << " triangles | "
+                      << gpu.cpuMs / std::max<long long>(gpu.frames, 1) << " ms CPU/frame" << std::endl;
+        }
+
+        const TextureStreamer::Stats& streaming = textureStreamer->getStats();
+        std::cout << "  textures " << streaming.residentBytes / (1024.0 * 1024.0) << " MB resident, "
+                  << streaming.requestedBytes / (1024.0 * 1024.0) << " MB requested | "
+                  << streaming.streamIns << " streamed in, " << streaming.streamOuts << " out" << std::endl;
+        std::cout << "  render targets " << renderTargetPool->getTotalAllocations() - targetAllocationsBefore
+                  << " allocated during the run, at most " << maxFrameTargetAllocations << " in one frame" << std::endl;
+    }
+
+    if (!screenshotPath.empty())
+        saveScreenshot(screenshotPath);
+
+    PROFILE_DUMP("profile_trace.json");
+}
+
+void Engine::saveScreenshot(const std::string& path) {
+    std::vector<unsigned char> pixels((size_t)width * height * 3);
+
+    glState->bindFramebuffer(GL_FRAMEBUFFER, defaultFramebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Failed to write screenshot: " << path << std::endl;
+        return;
+    }
+
+    // Binary PPM, rows flipped from GL's bottom-up order
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (int y = height - 1; y >= 0; y--)
+        file.write((const char*)&pixels[(size_t)y * width * 3], (std::streamsize)width * 3);
+
+    std::cout << "Screenshot saved: " << path << std::endl;
+}
+
+void Engine::reportStartup() {
+    double startupMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - g_startupBegin).count();
+
+    const ShaderCache::Stats& cache = ShaderCache::stats;
+    std::cout << "Startup: " << startupMs << " ms | shader cache "
+              << (ShaderCache::isAvailable() ? "ON" : "OFF")
+              << " (" << cache.hits << " hits, " << cache.misses << " misses)"
+              << " | binary load " << cache.loadMs << " ms, compile " << cache.compileMs << " ms"
+              << std::endl;
+
+    const ShaderLibrary::Stats& library = shaderLibrary->getStats();
+    std::cout << "Shader library: " << library.programs << " programs for "
+              << library.requests << " requests (" << library.deduplicated << " shared)"
+              << " | parallel compile " << (GLExt.parallelShaderCompile ? "ON" : "OFF")
+              << std::endl;
+
+    const TextureManager::Stats& textures = textureManager->getStats();
+    std::cout << "Textures: " << textures.residentTextures << " resident ("
+              << textures.residentBytes / (1024.0 * 1024.0) << " MB) | "
+              << textures.hits << " hits, " << textures.misses << " misses | "
+              << textureLoader->getPendingCount() << " still loading"
+              << " | " << textureArrays->getLayerCount() << " layers in "
+              << textureArrays->getArrayCount() << " arrays"
+              << std::endl;
+
+    const TextureStreamer::Stats& streaming = textureStreamer->getStats();
+    std::cout << "Texture streaming: " << streaming.streamedTextures << " textures, "
+              << streaming.residentBytes / (1024.0 * 1024.0) << " MB resident of "
+              << streaming.budgetBytes / (1024.0 * 1024.0) << " MB budget"
+              << std::endl;
+
+    const MeshBuilder::Stats& meshes = MeshBuilder::getStats();
+    if (meshes.triangles > 0) {
+        std::cout << "Meshes: " << meshes.meshes << " built, " << meshes.vertices << " vertices (from "
+                  << meshes.inputVertices << ") | ACMR " << meshes.missesBefore / meshes.triangles
+                  << " -> " << meshes.missesAfter / meshes.triangles
+                  << " | " << meshes.vertexBytes / 1024.0 << " KB vertex data, "
+                  << VertexFormat::getDefault().getStride() << " bytes/vertex" << std::endl;
+    }
+
+    const MeshImporter::Stats& imports = meshImporter->getStats();
+    if (imports.imported + imports.cacheHits > 0) {
+        std::cout << "Mesh import: " << imports.imported << " parsed (" << imports.importMs << " ms), "
+                  << imports.cacheHits << " from cache (" << imports.cacheLoadMs << " ms), "
+                  << imports.lodLevels << " LOD levels | "
+                  << imports.uploadedBytes / 1024.0 << " KB uploaded" << std::endl;
+    }
 }
 
 void Engine::processInput() {
@@ -161,6 +500,9 @@ void Engine::processInput() {
         std::cout << "FPS limit: 70" << std::endl;
     }
 
+    if (input->isKeyPressed(GLFW_KEY_F9))
+        PROFILE_DUMP("profile_trace.json");
+
     if (input->isKeyPressed(GLFW_KEY_0)) {
         targetFPS = 0;
         std::cout << "FPS limit: OFF" << std::endl;
@@ -175,17 +517,21 @@ void Engine::update() {
     front.z = sin(glm::radians(input->yaw)) * cos(glm::radians(input->pitch));
     cameraFront = glm::normalize(front);
 
-    if (currentScene)
+    if (currentScene) {
+        PROFILE_SCOPE("Scene::update");
         currentScene->update(deltaTime);
+    }
 }
 
 void Engine::render() {
-    int displayW, displayH;
-    glfwGetFramebufferSize(window, &displayW, &displayH);
+    PROFILE_FUNCTION();
+
+    int displayW = framebufferSize.x;
+    int displayH = framebufferSize.y;
     float aspectRatio = (displayH == 0) ? 1.0f : (float)displayW / displayH;
 
     if (!currentScene) {
-        glViewport(0, 0, displayW, displayH);
+        glState->viewport(0, 0, displayW, displayH);
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         return;
@@ -197,48 +543,62 @@ void Engine::render() {
     glm::mat4 lightView       = glm::lookAt(lightPos, glm::vec3(0.0f), glm::vec3(0, 1, 0));
     lightSpaceMatrix          = lightProjection * lightView;
 
-    shadowMap->bind();
-    glClear(GL_DEPTH_BUFFER_BIT);
+    {
+        PROFILE_SCOPE("Shadow");
+        GPU_SCOPE("Shadow");
 
-    depthShader->use();
-    depthShader->setMat4("lightSpaceMatrix", lightSpaceMatrix);
+        shadowMap->bind();
+        glClear(GL_DEPTH_BUFFER_BIT);
 
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_FRONT);
+        depthShader->use();
+        depthShader->setMat4("lightSpaceMatrix", lightSpaceMatrix);
 
-    currentScene->drawDepth(*depthShader);
+        glState->setEnabled(GL_DEPTH_TEST, true);
+        glState->setEnabled(GL_CULL_FACE, true);
+        glState->cullFace(GL_FRONT);
 
-    glCullFace(GL_BACK);
+        currentScene->drawDepth(*depthShader, lightSpaceMatrix);
 
-    shadowMap->unbind(displayW, displayH);
+        glState->cullFace(GL_BACK);
 
-    glViewport(0, 0, displayW, displayH);
+        shadowMap->unbind(displayW, displayH);
+    }
+
+    glState->viewport(0, 0, displayW, displayH);
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     glm::mat4 projection = glm::perspective(glm::radians(input->fov), aspectRatio, 0.1f, 100.0f);
     glm::mat4 view       = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-
-    lightingShader->use();
-    lightingShader->setMat4("projection", projection);
-    lightingShader->setMat4("view",       view);
-    lightingShader->setMat4("lightSpaceMatrix", lightSpaceMatrix);
-
-    lightingShader->setVec3("viewPos",    cameraPos);
-    lightingShader->setVec3("lightPos",   lightPos);
-    lightingShader->setVec3("lightColor", glm::vec3(1.0f));
-    lightingShader->setVec3("objectColor", glm::vec3(1.0f));
+    textureStreamer->beginFrame(projection, displayH);
 
     const int SHADOW_TEX_UNIT = 3;
-    glActiveTexture(GL_TEXTURE0 + SHADOW_TEX_UNIT);
-    glBindTexture(GL_TEXTURE_2D, shadowMap->depthMap);
-    lightingShader->setInt("shadowMap", SHADOW_TEX_UNIT);
+    glState->bindTexture(SHADOW_TEX_UNIT, GL_TEXTURE_2D, shadowMap->depthMap);
+
+    glm::vec3 viewPos = cameraPos;
+    glm::mat4 lightSpace = lightSpaceMatrix;
+    lightingShaders->beginFrame();
+    lightingShaders->addFrameSetup([=](Shader& shader) {
+        shader.setMat4("projection", projection);
+        shader.setMat4("view",       view);
+        shader.setMat4("lightSpaceMatrix", lightSpace);
+
+        shader.setVec3("viewPos",    viewPos);
+        shader.setVec3("lightPos",   lightPos);
+        shader.setVec3("lightColor", glm::vec3(1.0f));
+        shader.setVec3("objectColor", glm::vec3(1.0f));
+
+        shader.setInt("shadowMap", SHADOW_TEX_UNIT);
+        shader.setInt("material.albedoMap", 0);
+    });
 
-    currentScene->draw(*lightingShader, *lampShader, view, projection);
+    PROFILE_SCOPE("Scene");
+    GPU_SCOPE("Scene");
+    currentScene->draw(*lightingShaders, *lampShader, view, projection);
 }
 
 void Engine::framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height);
+    GGLState->viewport(0, 0, width, height);
 }
 
 void Engine::mouse_callback(GLFWwindow* window, double xpos, double ypos) {
@@ -0,0 +1,68 @@
+#include "GLExtensions.h"
+#include <cstring>
+
+GLExtensions GLExt;
+
+bool hasGLExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+static bool versionAtLeast(int major, int minor) {
+    return GLExt.versionMajor > major || (GLExt.versionMajor == major && GLExt.versionMinor >= minor);
+}
+
+void loadGLExtensions(GLADloadproc load) {
+    glGetIntegerv(GL_MAJOR_VERSION, &GLExt.versionMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &GLExt.versionMinor);
+
+    if (versionAtLeast(4, 1) || hasGLExtension("GL_ARB_get_program_binary")) {
+        GLExt.GetProgramBinary  = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+        GLExt.ProgramBinary     = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+        GLExt.ProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+        GLExt.programBinary = GLExt.GetProgramBinary && GLExt.ProgramBinary &&
+                              GLExt.ProgramParameteri && formats > 0;
+    }
+
+    if (hasGLExtension("GL_KHR_parallel_shader_compile")) {
+        GLExt.MaxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+        GLExt.parallelShaderCompile = true;
+    } else if (hasGLExtension("GL_ARB_parallel_shader_compile")) {
+        GLExt.MaxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+        GLExt.parallelShaderCompile = true;
+    }
+
+    if (versionAtLeast(4, 3) && (versionAtLeast(4, 4) || hasGLExtension("GL_ARB_buffer_storage"))) {
+        GLExt.DispatchCompute           = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+        GLExt.MemBarrier                = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+        GLExt.BindImageTexture          = (PFNGLBINDIMAGETEXTUREPROC)load("glBindImageTexture");
+        GLExt.ClearBufferData           = (PFNGLCLEARBUFFERDATAPROC)load("glClearBufferData");
+        GLExt.MultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+        GLExt.BufferStorage             = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+
+        GLExt.gpuDriven = GLExt.DispatchCompute && GLExt.MemBarrier && GLExt.BindImageTexture &&
+                          GLExt.ClearBufferData && GLExt.MultiDrawElementsIndirect && GLExt.BufferStorage;
+    }
+
+    if (versionAtLeast(4, 6)) {
+        GLExt.MultiDrawElementsIndirectCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)load("glMultiDrawElementsIndirectCount");
+    } else if (hasGLExtension("GL_ARB_indirect_parameters")) {
+        GLExt.MultiDrawElementsIndirectCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)load("glMultiDrawElementsIndirectCountARB");
+    }
+    GLExt.indirectParameters = GLExt.MultiDrawElementsIndirectCount != nullptr;
+
+    GLExt.textureCompressionS3TC = hasGLExtension("GL_EXT_texture_compression_s3tc");
+    GLExt.textureCompressionS3TCSrgb = GLExt.textureCompressionS3TC &&
+        (hasGLExtension("GL_EXT_texture_sRGB") || hasGLExtension("GL_EXT_texture_compression_s3tc_srgb"));
+    GLExt.textureCompressionBPTC = versionAtLeast(4, 2) || hasGLExtension("GL_ARB_texture_compression_bptc");
+}
@@ -0,0 +1,191 @@
+#include "GLState.h"
+#include <algorithm>
+#include <iterator>
+
+GLState* GGLState = nullptr;
+
+static const GLenum kTrackedTargets[] = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP };
+static const GLenum kTrackedCapabilities[] = { GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND };
+
+template <size_t N>
+static int indexOf(const GLenum (&values)[N], GLenum value) {
+    for (size_t i = 0; i < N; i++)
+        if (values[i] == value) return (int)i;
+    return -1;
+}
+
+GLState::GLState() {
+    invalidate();
+}
+
+GLState::~GLState() {
+    // Meshes in static caches can outlive the engine
+    if (GGLState == this) GGLState = nullptr;
+}
+
+void GLState::count(bool issued) {
+    if (issued) {
+        frameStats.issued++;
+        totals.issued++;
+    } else {
+        frameStats.elided++;
+        totals.elided++;
+    }
+}
+
+void GLState::useProgram(unsigned int value) {
+    if (change(program, value))
+        glUseProgram(value);
+}
+
+void GLState::bindVertexArray(unsigned int vao) {
+    if (change(vertexArray, vao))
+        glBindVertexArray(vao);
+}
+
+void GLState::bindFramebuffer(GLenum target, unsigned int framebuffer) {
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool differs = (read && readFramebuffer != framebuffer) || (draw && drawFramebuffer != framebuffer);
+    count(differs);
+    if (!differs) return;
+
+    glBindFramebuffer(target, framebuffer);
+    if (read) readFramebuffer = framebuffer;
+    if (draw) drawFramebuffer = framebuffer;
+}
+
+void GLState::viewport(int x, int y, int width, int height) {
+    int rect[4] = { x, y, width, height };
+    bool differs = !std::equal(std::begin(rect), std::end(rect), std::begin(viewportRect));
+    count(differs);
+    if (!differs) return;
+
+    glViewport(x, y, width, height);
+    std::copy(std::begin(rect), std::end(rect), std::begin(viewportRect));
+}
+
+void GLState::activeTexture(int unit) {
+    if (change(activeUnit, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+bool GLState::bindTexture(int unit, GLenum target, unsigned int texture) {
+    int slot = indexOf(kTrackedTargets, target);
+    if (slot < 0 || unit >= kMaxUnits) {
+        activeTexture(unit);
+        glBindTexture(target, texture);
+        count(true);
+        return true;
+    }
+
+    if (textures[unit][slot] == texture) {
+        count(false);
+        return false;
+    }
+    activeTexture(unit);
+    glBindTexture(target, texture);
+    textures[unit][slot] = texture;
+    count(true);
+    return true;
+}
+
+void GLState::setEnabled(GLenum capability, bool enabled) {
+    int slot = indexOf(kTrackedCapabilities, capability);
+    if (slot >= 0 && !change(capabilities[slot], (int)enabled))
+        return;
+    if (slot < 0)
+        count(true);
+
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void GLState::depthFunc(GLenum func) {
+    if (change(depthFuncValue, (unsigned int)func))
+        glDepthFunc(func);
+}
+
+void GLState::depthMask(bool write) {
+    if (change(depthWrite, (int)write))
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::cullFace(GLenum face) {
+    if (change(cullFaceValue, (unsigned int)face))
+        glCullFace(face);
+}
+
+void GLState::blendFunc(GLenum source, GLenum destination) {
+    bool differs = blendSource != source || blendDestination != destination;
+    count(differs);
+    if (!differs) return;
+
+    glBlendFunc(source, destination);
+    blendSource = source;
+    blendDestination = destination;
+}
+
+void GLState::colorMask(bool write) {
+    GLboolean value = write ? GL_TRUE : GL_FALSE;
+    if (change(colorWrite, (int)write))
+        glColorMask(value, value, value, value);
+}
+
+unsigned int GLState::getProgram() {
+    if (program == kUnknown) {
+        GLint current = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+        program = (unsigned int)current;
+    }
+    return program;
+}
+
+unsigned int GLState::getDrawFramebuffer() {
+    if (drawFramebuffer == kUnknown) {
+        GLint current = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &current);
+        drawFramebuffer = (unsigned int)current;
+    }
+    return drawFramebuffer;
+}
+
+void GLState::forgetVertexArray(unsigned int vao) {
+    if (vertexArray == vao) vertexArray = 0;
+}
+
+void GLState::forgetFramebuffer(unsigned int framebuffer) {
+    if (readFramebuffer == framebuffer) readFramebuffer = 0;
+    if (drawFramebuffer == framebuffer) drawFramebuffer = 0;
+}
+
+void GLState::forgetTexture(unsigned int texture) {
+    for (auto& unit : textures)
+        for (unsigned int& bound : unit)
+            if (bound == texture) bound = 0;
+}
+
+void GLState::invalidateTextures() {
+    activeUnit = -1;
+    for (auto& unit : textures)
+        std::fill(std::begin(unit), std::end(unit), kUnknown);
+}
+
+void GLState::invalidate() {
+    program = kUnknown;
+    vertexArray = kUnknown;
+    readFramebuffer = drawFramebuffer = kUnknown;
+    std::fill(std::begin(viewportRect), std::end(viewportRect), -1);
+    invalidateTextures();
+
+    std::fill(std::begin(capabilities), std::end(capabilities), -1);
+    depthFuncValue = cullFaceValue = kUnknown;
+    blendSource = blendDestination = kUnknown;
+    depthWrite = colorWrite = -1;
+}
+
+void GLState::beginFrame() {
+    frameStats = Stats();
+}
@@ -0,0 +1,730 @@
+#include "GpuDrivenRenderer.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "Profiler.h"
+#include "ShaderLibrary.h"
+#include "Texture.h"
+#include "VertexFormat.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+GpuDrivenRenderer* GGpuDrivenRenderer = nullptr;
+bool GpuDrivenRenderer::enabled = false;
+
+static const int kRingFrames = 3;
+static const int kHiZUnit = 12;             // clear of the material (0) and shadow map (10) units
+static const GLuint kCullGroupSize = 64;    // local_size_x of gpu_cull.comp
+static const int kStatCounters = 4;         // tested, frustum-culled, occluded, triangles
+
+// std430 layouts of gpu_cull.comp
+struct ObjectData {
+    glm::mat4 model;
+    glm::vec4 normalMatrix[3];
+    glm::vec4 material;
+    glm::vec4 sphere;
+    glm::vec4 lodCenter;
+    uint32_t firstMesh;
+    uint32_t levelCount;
+    uint32_t group;
+    uint32_t pad;
+};
+static_assert(sizeof(ObjectData) == 176, "ObjectData must match Object in gpu_cull.comp");
+
+struct PoolMesh {
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    float error;
+    glm::mat4 dequantize;
+};
+static_assert(sizeof(PoolMesh) == 80, "PoolMesh must match PoolMesh in gpu_cull.comp");
+
+struct DrawCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+// mat4 model, three vec4 normal matrix columns, vec4 material
+static const GLsizei kDrawDataSize = 128;
+
+namespace {
+
+// Adds the time spent in the scope to a running total
+struct CpuTimer {
+    double& total;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    explicit CpuTimer(double& total) : total(total) {}
+    ~CpuTimer() {
+        total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// Callers keep setting uniforms on their own program after ours ran
+struct ProgramScope {
+    unsigned int previous = GGLState->getProgram();
+
+    ~ProgramScope() { GGLState->useProgram(previous); }
+};
+
+}
+
+static unsigned int loadComputeProgram(const char* path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "ERROR::GPU_DRIVEN:: Cannot read " << path << std::endl;
+        return 0;
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    std::string code = stream.str();
+    const char* source = code.c_str();
+
+    int success = 0;
+    char infoLog[1024];
+    unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+        std::cout << "ERROR::GPU_DRIVEN:: Compiling " << path << " failed\n" << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glDeleteShader(shader);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, sizeof(infoLog), nullptr, infoLog);
+        std::cout << "ERROR::GPU_DRIVEN:: Linking " << path << " failed\n" << infoLog << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+static void waitFence(GLsync fence) {
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull) == GL_TIMEOUT_EXPIRED) {}
+    glDeleteSync(fence);
+}
+
+// LOD chains are shared between shapes, so they key the pool; plain meshes key themselves
+static const void* poolKey(const Shape* shape) {
+    if (shape->getLodChain()) return shape->getLodChain();
+    return shape->getLodMeshes().front().get();
+}
+
+GpuDrivenRenderer::GpuDrivenRenderer() {
+    cullProgram = loadComputeProgram(PROJECT_ROOT_DIR "/src/gpu_cull.comp");
+    reduceProgram = loadComputeProgram(PROJECT_ROOT_DIR "/src/hiz_reduce.comp");
+    depthShader = GShaderLibrary->load(
+        PROJECT_ROOT_DIR "/src/lighting.vert",
+        PROJECT_ROOT_DIR "/src/shadow_depth.frag",
+        { "GPU_DRIVEN" }
+    );
+
+    glGenBuffers(1, &poolVBO);
+    glGenBuffers(1, &poolEBO);
+    glGenBuffers(1, &meshBuffer);
+    glGenBuffers(1, &groupBuffer);
+    glGenBuffers(1, &lodStateBuffer);
+    for (PassBuffers& pass : passes) {
+        glGenVertexArrays(1, &pass.VAO);
+        glGenBuffers(1, &pass.commands);
+        glGenBuffers(1, &pass.draws);
+        glGenBuffers(1, &pass.counters);
+    }
+
+    // Main pass counters land here and are read once the frame's fence passed
+    GLsizeiptr statsSize = kRingFrames * kStatCounters * sizeof(uint32_t);
+    GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &statsBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, statsBuffer);
+    GLExt.BufferStorage(GL_COPY_WRITE_BUFFER, statsSize, nullptr, flags);
+    statsMapped = (const uint32_t*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, statsSize, flags);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+GpuDrivenRenderer::~GpuDrivenRenderer() {
+    for (GLsync& fence : fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    if (objectBuffer) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, objectBuffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, statsBuffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    unsigned int buffers[] = { poolVBO, poolEBO, meshBuffer, groupBuffer, lodStateBuffer, objectBuffer, statsBuffer };
+    glDeleteBuffers(7, buffers);
+    for (PassBuffers& pass : passes) {
+        GGLState->forgetVertexArray(pass.VAO);
+        glDeleteVertexArrays(1, &pass.VAO);
+        glDeleteBuffers(1, &pass.commands);
+        glDeleteBuffers(1, &pass.draws);
+        glDeleteBuffers(1, &pass.counters);
+    }
+
+    if (cullProgram) glDeleteProgram(cullProgram);
+    if (reduceProgram) glDeleteProgram(reduceProgram);
+    GGLState->forgetFramebuffer(depthCopyFBO);
+    GGLState->forgetTexture(depthCopyTexture);
+    GGLState->forgetTexture(hiZTexture);
+    if (depthCopyFBO) glDeleteFramebuffers(1, &depthCopyFBO);
+    if (depthCopyTexture) glDeleteTextures(1, &depthCopyTexture);
+    if (hiZTexture) glDeleteTextures(1, &hiZTexture);
+}
+
+void GpuDrivenRenderer::update(const std::vector<std::shared_ptr<Shape>>& shapes) {
+    PROFILE_FUNCTION();
+
+    // This frame's ring region was last read three frames ago
+    if (fences[frame]) {
+        waitFence(fences[frame]);
+        fences[frame] = nullptr;
+        readStats(frame);
+    }
+    CpuTimer timer(stats.cpuMs);
+
+    bool changed = shapes.size() != shapeList.size();
+    for (size_t i = 0; !changed && i < shapes.size(); i++)
+        changed = shapes[i].get() != shapeList[i];
+    if (changed)
+        rebuild(shapes);
+
+    // Textures finish streaming in after load, which moves shapes between arrays
+    for (Entry& entry : entries) {
+        const std::shared_ptr<Texture>& albedo = entry.shape->getAlbedoMap();
+        int layer = albedo ? albedo->getLayer() : 0;
+        if ((albedo ? albedo->getArray() : nullptr) != groups[entry.group].array)
+            regroup = true;
+
+        if (entry.shape->getVersion() != entry.shapeVersion || layer != entry.layer) {
+            entry.shapeVersion = entry.shape->getVersion();
+            entry.layer = layer;
+            entry.stamp = ++stampCounter;
+        }
+    }
+    if (regroup)
+        updateGroups();
+
+    uint8_t* region = objectMapped + frame * regionSize;
+    for (size_t i = 0; i < entries.size(); i++) {
+        Entry& entry = entries[i];
+        if (entry.written[frame] == entry.stamp) continue;
+        writeObject(entry, region + i * sizeof(ObjectData));
+        entry.written[frame] = entry.stamp;
+    }
+}
+
+void GpuDrivenRenderer::rebuild(const std::vector<std::shared_ptr<Shape>>& shapes) {
+    shapeList.clear();
+    std::vector<Shape*> candidates;
+    const VertexFormat* format = &VertexFormat::getDefault();
+    for (const auto& shape : shapes) {
+        shapeList.push_back(shape.get());
+
+        // Every level is drawn through one VAO, so all must share its layout
+        std::vector<std::shared_ptr<Mesh>> meshes = shape->getLodMeshes();
+        bool fits = !meshes.empty();
+        for (const std::shared_ptr<Mesh>& mesh : meshes)
+            fits = fits && mesh->getFormat() == format;
+        shape->batched = fits;
+        if (fits) candidates.push_back(shape.get());
+    }
+
+    buildPool(candidates);
+    allocateObjects(candidates.size());
+
+    entries.clear();
+    for (Shape* shape : candidates) {
+        const PoolEntry& source = pool.at(poolKey(shape));
+        Entry entry;
+        entry.shape = shape;
+        entry.firstMesh = source.firstRow;
+        entry.levelCount = (uint32_t)source.meshes.size();
+        entry.group = UINT32_MAX;
+        entry.stamp = ++stampCounter;
+        entries.push_back(entry);
+    }
+    updateGroups();
+    setupVertexArrays();
+
+    // Object indices moved, so the per-object LOD state starts over
+    int none = -1;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, lodStateBuffer);
+    GLExt.ClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32I, GL_RED_INTEGER, GL_INT, &none);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuDrivenRenderer::buildPool(const std::vector<Shape*>& candidates) {
+    // Only a mesh the pool lacks makes it rebuild; everything is re-uploaded then
+    bool missing = false;
+    for (Shape* shape : candidates)
+        missing = missing || !pool.count(poolKey(shape));
+    if (!missing) return;
+
+    PROFILE_FUNCTION();
+    auto start = std::chrono::steady_clock::now();
+
+    std::unordered_map<const void*, PoolEntry> next;
+    std::vector<PoolMesh> table;
+    std::vector<unsigned int> indices;
+    std::vector<std::pair<const Mesh*, size_t>> copies;
+    size_t stride = VertexFormat::getDefault().getStride();
+    uint32_t vertexCount = 0;
+    meshBounds.clear();
+
+    for (Shape* shape : candidates) {
+        const void* key = poolKey(shape);
+        if (next.count(key)) continue;
+
+        PoolEntry entry;
+        entry.meshes = shape->getLodMeshes();
+        entry.firstRow = (uint32_t)table.size();
+        const LodChain* chain = shape->getLodChain();
+
+        for (size_t level = 0; level < entry.meshes.size(); level++) {
+            const Mesh* mesh = entry.meshes[level].get();
+            std::vector<float> vertices;
+            std::vector<unsigned int> meshIndices;
+            mesh->readBack(vertices, meshIndices);
+
+            PoolMesh row;
+            row.indexCount = (uint32_t)meshIndices.size();
+            row.firstIndex = (uint32_t)indices.size();
+            row.baseVertex = (int32_t)vertexCount;
+            row.error = chain ? chain->levels[level].error : 0.0f;
+            row.dequantize = mesh->getDequantize();
+            table.push_back(row);
+            indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+
+            // readBack dequantizes, so the sphere is in mesh space
+            glm::vec3 low(INFINITY), high(-INFINITY);
+            for (size_t v = 0; v + 8 <= vertices.size(); v += 8) {
+                glm::vec3 p(vertices[v], vertices[v + 1], vertices[v + 2]);
+                low = glm::min(low, p);
+                high = glm::max(high, p);
+            }
+            meshBounds.push_back(low.x <= high.x ? glm::vec4(0.5f * (low + high), 0.5f * glm::length(high - low))
+                                                 : glm::vec4(0.0f));
+
+            // Vertices are copied as stored, quantized or not
+            copies.emplace_back(mesh, (size_t)vertexCount * stride);
+            vertexCount += (uint32_t)mesh->getVertexCount();
+        }
+        next.emplace(key, std::move(entry));
+    }
+    pool.swap(next);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, poolVBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexCount * stride, nullptr, GL_STATIC_DRAW);
+    for (const auto& copy : copies)
+        copy.first->copyVertices(poolVBO, copy.second);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, poolEBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, meshBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, table.size() * sizeof(PoolMesh), table.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double bytes = (double)vertexCount * stride + indices.size() * sizeof(unsigned int);
+    std::cout << "GPU-driven pool: " << table.size() << " meshes, " << vertexCount << " vertices, "
+              << indices.size() / 3 << " triangles, " << bytes / (1024.0 * 1024.0) << " MB, "
+              << ms << " ms" << std::endl;
+}
+
+void GpuDrivenRenderer::allocateObjects(size_t count) {
+    if (objectBuffer && count <= objectCapacity) return;
+
+    size_t capacity = 256;
+    while (capacity < count) capacity *= 2;
+
+    // Frames in flight may still read the old buffers
+    if (objectBuffer) {
+        glFinish();
+        for (GLsync& fence : fences) {
+            if (fence) glDeleteSync(fence);
+            fence = nullptr;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, objectBuffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glDeleteBuffers(1, &objectBuffer);
+    }
+
+    GLint alignment = 256;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment = std::max(alignment, 256);
+    regionSize = (capacity * sizeof(ObjectData) + alignment - 1) / alignment * alignment;
+
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &objectBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, objectBuffer);
+    GLExt.BufferStorage(GL_COPY_WRITE_BUFFER, regionSize * kRingFrames, nullptr, flags);
+    objectMapped = (uint8_t*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, regionSize * kRingFrames, flags);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, lodStateBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity * LOD_PASS_COUNT * sizeof(int), nullptr, GL_DYNAMIC_COPY);
+    for (PassBuffers& pass : passes) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pass.commands);
+        glBufferData(GL_COPY_WRITE_BUFFER, capacity * sizeof(DrawCommand), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pass.draws);
+        glBufferData(GL_COPY_WRITE_BUFFER, capacity * kDrawDataSize, nullptr, GL_DYNAMIC_COPY);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    objectCapacity = capacity;
+}
+
+void GpuDrivenRenderer::updateGroups() {
+    // One multi-draw per lighting variant and texture array; everything else is per draw
+    groups.clear();
+    for (Entry& entry : entries) {
+        const std::shared_ptr<Texture>& albedo = entry.shape->getAlbedoMap();
+        uint32_t features = entry.shape->getMaterialFeatures();
+        const TextureArray* array = albedo ? albedo->getArray() : nullptr;
+
+        uint32_t group = 0;
+        while (group < groups.size() && (groups[group].features != features || groups[group].array != array))
+            group++;
+        if (group == groups.size())
+            groups.push_back({ features, array, albedo });
+
+        if (entry.group != group) {
+            entry.group = group;
+            entry.stamp = ++stampCounter;
+        }
+        groups[group].capacity++;
+    }
+
+    std::vector<uint32_t> bases;
+    uint32_t base = 0;
+    for (Group& group : groups) {
+        group.base = base;
+        bases.push_back(base);
+        base += group.capacity;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, groupBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, std::max<size_t>(bases.size(), 1) * sizeof(uint32_t), bases.data(), GL_STATIC_DRAW);
+    for (PassBuffers& pass : passes) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pass.counters);
+        glBufferData(GL_COPY_WRITE_BUFFER, (groups.size() + kStatCounters) * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    regroup = false;
+}
+
+void GpuDrivenRenderer::setupVertexArrays() {
+    const VertexFormat& format = VertexFormat::getDefault();
+    for (PassBuffers& pass : passes) {
+        GGLState->bindVertexArray(pass.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, poolVBO);
+        format.apply();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, poolEBO);
+
+        // Per-draw data, indexed by each command's baseInstance
+        glBindBuffer(GL_ARRAY_BUFFER, pass.draws);
+        for (GLuint i = 0; i < 4; i++) {
+            glEnableVertexAttribArray(3 + i);
+            glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, kDrawDataSize, (void*)(uintptr_t)(i * 16));
+            glVertexAttribDivisor(3 + i, 1);
+        }
+        for (GLuint i = 0; i < 3; i++) {
+            glEnableVertexAttribArray(7 + i);
+            glVertexAttribPointer(7 + i, 3, GL_FLOAT, GL_FALSE, kDrawDataSize, (void*)(uintptr_t)(64 + i * 16));
+            glVertexAttribDivisor(7 + i, 1);
+        }
+        glEnableVertexAttribArray(10);
+        glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, kDrawDataSize, (void*)(uintptr_t)112);
+        glVertexAttribDivisor(10, 1);
+    }
+    GGLState->bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GpuDrivenRenderer::writeObject(const Entry& entry, uint8_t* out) const {
+    const Shape* shape = entry.shape;
+    ObjectData data;
+    data.model = shape->getMeshMatrix();
+    const glm::mat3& normalMatrix = shape->getNormalMatrix();
+    for (int i = 0; i < 3; i++)
+        data.normalMatrix[i] = glm::vec4(normalMatrix[i], 0.0f);
+    data.material = glm::vec4(shape->getColor(), (float)entry.layer);
+
+    // Coarser levels stay within the finest level's bounds up to their error
+    glm::mat3 linear(data.model);
+    float scale = std::max(glm::length(linear[0]), std::max(glm::length(linear[1]), glm::length(linear[2])));
+    glm::vec4 bounds = meshBounds[entry.firstMesh];
+    data.sphere = glm::vec4(glm::vec3(data.model * glm::vec4(glm::vec3(bounds), 1.0f)), bounds.w * scale);
+    data.lodCenter = glm::vec4(shape->position, std::max(shape->scale.x, std::max(shape->scale.y, shape->scale.z)));
+
+    data.firstMesh = entry.firstMesh;
+    data.levelCount = entry.levelCount;
+    data.group = entry.group;
+    data.pad = 0;
+    std::memcpy(out, &data, sizeof(data));
+}
+
+void GpuDrivenRenderer::cull(LodPass pass, const CullView& view, const LodView& lodView, bool occlusion) {
+    if (entries.empty() || !cullProgram) return;
+    PROFILE_FUNCTION();
+    CpuTimer timer(stats.cpuMs);
+    ProgramScope scope;
+
+    // Commands of groups that keep fewer objects than their capacity stay empty
+    PassBuffers& buffers = passes[pass];
+    uint32_t zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers.commands);
+    GLExt.ClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers.counters);
+    GLExt.ClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, objectBuffer, frame * regionSize, entries.size() * sizeof(ObjectData));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, meshBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, groupBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, lodStateBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buffers.commands);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, buffers.draws);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, buffers.counters);
+
+    bool testOcclusion = occlusion && hasOcclusion;
+    GGLState->useProgram(cullProgram);
+    auto location = [this](const char* name) { return glGetUniformLocation(cullProgram, name); };
+    glUniform1ui(location("objectCount"), (GLuint)entries.size());
+    glUniform1ui(location("groupCount"), (GLuint)groups.size());
+    glUniform4fv(location("planes"), 6, &view.planes[0].x);
+    glUniform3f(location("lodEye"), lodView.eye.x, lodView.eye.y, lodView.eye.z);
+    glUniform1f(location("lodPixelsPerUnit"), lodView.pixelsPerUnit);
+    glUniform1i(location("lodOrthographic"), lodView.orthographic);
+    glUniform1i(location("lodBias"), lodView.bias);
+    glUniform1ui(location("lodStateOffset"), (GLuint)(pass * objectCapacity));
+    glUniform1f(location("targetErrorPixels"), LodChain::targetErrorPixels);
+    glUniform1f(location("hysteresis"), LodChain::hysteresis);
+    glUniform1i(location("occlusion"), testOcclusion);
+    if (testOcclusion) {
+        glUniformMatrix4fv(location("occlusionViewProjection"), 1, GL_FALSE, &occlusionViewProjection[0][0]);
+        glUniform1i(location("hiZ"), kHiZUnit);
+        glUniform2i(location("hiZSize"), hiZWidth, hiZHeight);
+        glUniform1i(location("hiZLevels"), hiZLevels);
+        GGLState->bindTexture(kHiZUnit, GL_TEXTURE_2D, hiZTexture);
+    }
+
+    GLExt.DispatchCompute((GLuint)(entries.size() + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+    GLExt.MemBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+                     GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    if (pass == LOD_PASS_MAIN) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffers.counters);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, statsBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, groups.size() * sizeof(uint32_t),
+                            frame * kStatCounters * sizeof(uint32_t), kStatCounters * sizeof(uint32_t));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        statsPending[frame] = true;
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuDrivenRenderer::drawDepth(LodPass pass, const glm::mat4& view, const glm::mat4& projection) {
+    if (entries.empty()) return;
+    CpuTimer timer(stats.cpuMs);
+    ProgramScope scope;
+
+    depthShader->use();
+    depthShader->setMat4("view", view);
+    depthShader->setMat4("projection", projection);
+
+    // Depth needs no material, so all groups go in one call
+    GGLState->bindVertexArray(passes[pass].VAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, passes[pass].commands);
+    GLExt.MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)entries.size(), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    Mesh::drawCalls++;
+    stats.multiDraws++;
+}
+
+void GpuDrivenRenderer::draw(LodPass pass, ShaderVariants& shaders, uint32_t frameFeatures) {
+    if (entries.empty()) return;
+    CpuTimer timer(stats.cpuMs);
+
+    GGLState->bindVertexArray(passes[pass].VAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, passes[pass].commands);
+    if (GLExt.indirectParameters)
+        glBindBuffer(GL_PARAMETER_BUFFER_ARB, passes[pass].counters);
+
+    for (size_t g = 0; g < groups.size(); g++) {
+        const Group& group = groups[g];
+        if (group.capacity == 0) continue;
+
+        shaders.select(group.features | frameFeatures | FEATURE_GPU_DRIVEN);
+        if (group.texture)
+            group.texture->bind(0);
+
+        // Without a GPU-side count the whole range is submitted; cleared commands draw nothing
+        const void* offset = (const void*)(uintptr_t)(group.base * sizeof(DrawCommand));
+        if (GLExt.indirectParameters)
+            GLExt.MultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, offset, (GLintptr)(g * sizeof(uint32_t)),
+                                                 (GLsizei)group.capacity, 0);
+        else
+            GLExt.MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, offset, (GLsizei)group.capacity, 0);
+
+        Mesh::drawCalls++;
+        stats.multiDraws++;
+    }
+
+    if (GLExt.indirectParameters)
+        glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+bool GpuDrivenRenderer::createOcclusionTargets(int framebuffer, int width, int height) {
+    // The copy must match the source depth format exactly for the blit
+    GLenum attachment = framebuffer == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+    GLint objectType = GL_NONE, depthBits = 0, stencilBits = 0, componentType = 0;
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &objectType);
+    if (objectType == GL_NONE) return false;
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depthBits);
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencilBits);
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE, &componentType);
+
+    bool stencil = stencilBits > 0;
+    GLenum internalFormat, format = stencil ? GL_DEPTH_STENCIL : GL_DEPTH_COMPONENT, type;
+    if (componentType == GL_FLOAT) {
+        internalFormat = stencil ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+        type = stencil ? GL_FLOAT_32_UNSIGNED_INT_24_8_REV : GL_FLOAT;
+    } else if (stencil) {
+        internalFormat = GL_DEPTH24_STENCIL8;
+        type = GL_UNSIGNED_INT_24_8;
+    } else {
+        internalFormat = depthBits <= 16 ? GL_DEPTH_COMPONENT16 : depthBits <= 24 ? GL_DEPTH_COMPONENT24 : GL_DEPTH_COMPONENT32;
+        type = depthBits <= 16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+
+    while (glGetError() != GL_NO_ERROR) {}
+
+    if (!depthCopyTexture) glGenTextures(1, &depthCopyTexture);
+    GGLState->bindTexture(kHiZUnit, GL_TEXTURE_2D, depthCopyTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+
+    if (!depthCopyFBO) glGenFramebuffers(1, &depthCopyFBO);
+    GGLState->bindFramebuffer(GL_DRAW_FRAMEBUFFER, depthCopyFBO);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                           GL_TEXTURE_2D, depthCopyTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    bool complete = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    // Farthest depth per texel; a full chain down to 1x1
+    hiZLevels = 1 + (int)std::floor(std::log2((double)std::max(width, height)));
+    if (!hiZTexture) glGenTextures(1, &hiZTexture);
+    GGLState->bindTexture(kHiZUnit, GL_TEXTURE_2D, hiZTexture);
+    for (int level = 0; level < hiZLevels; level++)
+        glTexImage2D(GL_TEXTURE_2D, level, GL_R32F, std::max(width >> level, 1), std::max(height >> level, 1), 0,
+                     GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, hiZLevels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // A blit between mismatched formats only shows up as an error here
+    if (complete) {
+        GGLState->bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
+    bool ok = complete && glGetError() == GL_NO_ERROR;
+
+    GGLState->bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    boundFramebuffer = framebuffer;
+    hiZWidth = width;
+    hiZHeight = height;
+    return ok;
+}
+
+void GpuDrivenRenderer::buildOcclusion(const glm::mat4& viewProjection, int width, int height) {
+    if (entries.empty() || !reduceProgram || occlusionFailed || width <= 0 || height <= 0) return;
+    PROFILE_FUNCTION();
+    CpuTimer timer(stats.cpuMs);
+    ProgramScope scope;
+
+    int framebuffer = (int)GGLState->getDrawFramebuffer();
+    if (framebuffer != boundFramebuffer || width != hiZWidth || height != hiZHeight) {
+        if (!createOcclusionTargets(framebuffer, width, height)) {
+            std::cout << "ERROR::GPU_DRIVEN:: Cannot copy the depth buffer, occlusion culling is off" << std::endl;
+            occlusionFailed = true;
+            hasOcclusion = false;
+            return;
+        }
+    }
+
+    GGLState->bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    GGLState->bindFramebuffer(GL_DRAW_FRAMEBUFFER, depthCopyFBO);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    GGLState->bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    GGLState->useProgram(reduceProgram);
+    glUniform1i(glGetUniformLocation(reduceProgram, "source"), kHiZUnit);
+    GLint sourceLevel = glGetUniformLocation(reduceProgram, "sourceLevel");
+    GLint copy = glGetUniformLocation(reduceProgram, "copy");
+
+    // Level 0 copies the depth, each further level reads the one above it
+    for (int level = 0; level < hiZLevels; level++) {
+        GGLState->bindTexture(kHiZUnit, GL_TEXTURE_2D, level == 0 ? depthCopyTexture : hiZTexture);
+        glUniform1i(sourceLevel, std::max(level - 1, 0));
+        glUniform1i(copy, level == 0);
+        GLExt.BindImageTexture(0, hiZTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+        int levelWidth = std::max(width >> level, 1);
+        int levelHeight = std::max(height >> level, 1);
+        GLExt.DispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+        GLExt.MemBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    occlusionViewProjection = viewProjection;
+    hasOcclusion = true;
+}
+
+void GpuDrivenRenderer::endFrame() {
+    if (fences[frame]) glDeleteSync(fences[frame]);
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame = (frame + 1) % kRingFrames;
+
+    stats.frames++;
+    stats.objects += (long long)entries.size();
+}
+
+void GpuDrivenRenderer::readStats(int region) {
+    if (!statsPending[region]) return;
+    const uint32_t* counters = statsMapped + region * kStatCounters;
+    stats.countedFrames++;
+    stats.tested += counters[0];
+    stats.frustumCulled += counters[1];
+    stats.occluded += counters[2];
+    stats.trianglesVisible += counters[3];
+    statsPending[region] = false;
+}
@@ -0,0 +1,100 @@
+#include "GpuProfiler.h"
+#include <sstream>
+#include <iomanip>
+
+GpuProfiler* GGpuProfiler = nullptr;
+
+// Query layout per frame: [0] frame start, [1] frame end, then begin/end per scope
+static int beginQuery(int scope) { return 2 + scope * 2; }
+static int endQuery(int scope)   { return 3 + scope * 2; }
+
+GpuProfiler::GpuProfiler() {
+    for (auto& frame : frames)
+        glGenQueries(kMaxScopes * 2 + 2, frame.queries);
+}
+
+GpuProfiler::~GpuProfiler() {
+    for (auto& frame : frames)
+        glDeleteQueries(kMaxScopes * 2 + 2, frame.queries);
+}
+
+void GpuProfiler::beginFrame() {
+    current = (current + 1) % kFrameLatency;
+    Frame& frame = frames[current];
+
+    // This slot was last used kFrameLatency - 1 frames ago
+    if (frame.submitted)
+        collect(frame);
+
+    frame.scopeCount = 0;
+    frame.submitted = false;
+    depth = 0;
+    inFrame = true;
+
+    glQueryCounter(frame.queries[0], GL_TIMESTAMP);
+}
+
+void GpuProfiler::endFrame() {
+    if (!inFrame) return;
+
+    Frame& frame = frames[current];
+    glQueryCounter(frame.queries[1], GL_TIMESTAMP);
+    frame.submitted = true;
+    inFrame = false;
+}
+
+int GpuProfiler::beginScope(const char* name) {
+    if (!inFrame) return -1;
+
+    Frame& frame = frames[current];
+    if (frame.scopeCount >= kMaxScopes) return -1;
+
+    int scope = frame.scopeCount++;
+    frame.scopes[scope] = { name, depth, false };
+    depth++;
+
+    glQueryCounter(frame.queries[beginQuery(scope)], GL_TIMESTAMP);
+    return scope;
+}
+
+void GpuProfiler::endScope(int scope) {
+    if (!inFrame || scope < 0) return;
+
+    Frame& frame = frames[current];
+    glQueryCounter(frame.queries[endQuery(scope)], GL_TIMESTAMP);
+    frame.scopes[scope].closed = true;
+    depth--;
+}
+
+void GpuProfiler::collect(Frame& frame) {
+    // The frame-end timestamp is issued last; once it is available so is everything before it
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    GLuint64 frameBegin = 0, frameEnd = 0;
+    glGetQueryObjectui64v(frame.queries[0], GL_QUERY_RESULT, &frameBegin);
+    glGetQueryObjectui64v(frame.queries[1], GL_QUERY_RESULT, &frameEnd);
+    frameTime = (frameEnd - frameBegin) / 1.0e6;
+
+    results.clear();
+    for (int i = 0; i < frame.scopeCount; i++) {
+        if (!frame.scopes[i].closed) continue;
+
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[beginQuery(i)], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[endQuery(i)], GL_QUERY_RESULT, &end);
+        results.push_back({ frame.scopes[i].name, frame.scopes[i].depth, (end - begin) / 1.0e6 });
+    }
+}
+
+std::string GpuProfiler::getSummary() const {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2) << "GPU " << frameTime << " ms";
+
+    for (const auto& pass : results) {
+        if (pass.depth > 1) continue;
+        ss << " | " << pass.name << " " << pass.milliseconds << " ms";
+    }
+    return ss.str();
+}
@@ -1,4 +1,5 @@
 #include "Input.h"
+#include "Profiler.h"
 
 Input* GInput = nullptr;
 
@@ -15,6 +16,8 @@ Input::Input() {
 }
 
 void Input::update(GLFWwindow* window) {
+    PROFILE_SCOPE("Input::update");
+
     previousKeys = currentKeys;
 
     for (int key = GLFW_KEY_SPACE; key <= GLFW_KEY_LAST; key++) {
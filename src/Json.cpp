@@ -0,0 +1,205 @@
+#include "Json.h"
+#include <cstdlib>
+#include <cstring>
+
+static const JsonValue kNull;
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+    if (type != Type::Array || index >= elements.size()) return kNull;
+    return elements[index];
+}
+
+const JsonValue& JsonValue::operator[](const char* key) const {
+    if (type != Type::Object) return kNull;
+    for (const auto& member : members)
+        if (member.first == key) return member.second;
+    return kNull;
+}
+
+namespace {
+
+struct JsonParser {
+    const char* at;
+    const char* end;
+    std::string error;
+    int depth = 0;
+
+    void skipSpace() {
+        while (at < end && (*at == ' ' || *at == '\t' || *at == '\n' || *at == '\r')) at++;
+    }
+
+    bool fail(const char* message) {
+        if (error.empty()) error = message;
+        return false;
+    }
+
+    bool literal(const char* word) {
+        size_t length = std::strlen(word);
+        if ((size_t)(end - at) < length || std::memcmp(at, word, length) != 0) return false;
+        at += length;
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned int codepoint) {
+        if (codepoint < 0x80) {
+            out += (char)codepoint;
+        } else if (codepoint < 0x800) {
+            out += (char)(0xC0 | (codepoint >> 6));
+            out += (char)(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+            out += (char)(0xE0 | (codepoint >> 12));
+            out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out += (char)(0x80 | (codepoint & 0x3F));
+        } else {
+            out += (char)(0xF0 | (codepoint >> 18));
+            out += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+            out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out += (char)(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    bool parseHex4(unsigned int& value) {
+        if (end - at < 4) return fail("truncated \\u escape");
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = *at++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return fail("bad \\u escape");
+        }
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        at++;   // opening quote
+        while (at < end && *at != '"') {
+            char c = *at++;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (at >= end) break;
+            char escape = *at++;
+            switch (escape) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned int codepoint;
+                    if (!parseHex4(codepoint)) return false;
+                    // Surrogate pair
+                    if (codepoint >= 0xD800 && codepoint < 0xDC00 && end - at >= 6 && at[0] == '\\' && at[1] == 'u') {
+                        at += 2;
+                        unsigned int low;
+                        if (!parseHex4(low)) return false;
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, codepoint);
+                    break;
+                }
+                default: return fail("bad escape in string");
+            }
+        }
+        if (at >= end) return fail("unterminated string");
+        at++;   // closing quote
+        return true;
+    }
+
+    bool parseValue(JsonValue& value) {
+        if (++depth > 256) return fail("nesting too deep");
+        skipSpace();
+        if (at >= end) return fail("unexpected end of input");
+
+        bool ok = true;
+        char c = *at;
+        if (c == '{') {
+            value.type = JsonValue::Type::Object;
+            at++;
+            skipSpace();
+            if (at < end && *at == '}') {
+                at++;
+            } else {
+                while (ok) {
+                    skipSpace();
+                    if (at >= end || *at != '"') { ok = fail("expected member name"); break; }
+                    value.members.emplace_back();
+                    if (!parseString(value.members.back().first)) { ok = false; break; }
+                    skipSpace();
+                    if (at >= end || *at != ':') { ok = fail("expected ':'"); break; }
+                    at++;
+                    if (!parseValue(value.members.back().second)) { ok = false; break; }
+                    skipSpace();
+                    if (at < end && *at == ',') { at++; continue; }
+                    if (at < end && *at == '}') { at++; break; }
+                    ok = fail("expected ',' or '}'");
+                }
+            }
+        } else if (c == '[') {
+            value.type = JsonValue::Type::Array;
+            at++;
+            skipSpace();
+            if (at < end && *at == ']') {
+                at++;
+            } else {
+                while (ok) {
+                    value.elements.emplace_back();
+                    if (!parseValue(value.elements.back())) { ok = false; break; }
+                    skipSpace();
+                    if (at < end && *at == ',') { at++; continue; }
+                    if (at < end && *at == ']') { at++; break; }
+                    ok = fail("expected ',' or ']'");
+                }
+            }
+        } else if (c == '"') {
+            value.type = JsonValue::Type::String;
+            ok = parseString(value.string);
+        } else if (literal("true")) {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = true;
+        } else if (literal("false")) {
+            value.type = JsonValue::Type::Bool;
+        } else if (literal("null")) {
+            value.type = JsonValue::Type::Null;
+        } else {
+            // strtod needs a terminated string; numbers are short, copy them out
+            char buffer[64];
+            size_t length = 0;
+            while (at + length < end && length < sizeof(buffer) - 1 &&
+                   std::strchr("+-0123456789.eE", at[length]) != nullptr)
+                length++;
+            if (length == 0) return fail("unexpected character");
+            std::memcpy(buffer, at, length);
+            buffer[length] = '\0';
+            value.type = JsonValue::Type::Number;
+            value.number = std::strtod(buffer, nullptr);
+            at += length;
+        }
+
+        depth--;
+        return ok;
+    }
+};
+
+}
+
+bool parseJson(const char* text, size_t length, JsonValue& out, std::string& error) {
+    JsonParser parser{ text, text + length, std::string(), 0 };
+    out = JsonValue();
+    if (!parser.parseValue(out)) {
+        error = parser.error;
+        return false;
+    }
+    parser.skipSpace();
+    if (parser.at != parser.end) {
+        error = "trailing characters";
+        return false;
+    }
+    return true;
+}
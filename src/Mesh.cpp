@@ -0,0 +1,189 @@
+#include "Mesh.h"
+#include "GLState.h"
+#include <cstring>
+
+long long Mesh::trianglesDrawn = 0;
+long long Mesh::vertexBytesFetched = 0;
+long long Mesh::drawCalls = 0;
+
+PackedMeshView PackedMesh::view() const {
+    PackedMeshView view;
+    view.format = format;
+    view.vertices = vertices.data();
+    view.positions = positions.data();
+    view.indices = indices.data();
+    view.vertexCount = vertexCount;
+    view.indexCount = indexCount;
+    view.indexType = indexType;
+    view.dequantize = dequantize;
+    view.meshlets = meshlets.data();
+    view.meshletCount = (int)meshlets.size();
+    return view;
+}
+
+PackedMesh Mesh::pack(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const VertexFormat& format) {
+    PackedMesh packed;
+    packed.format = &format;
+    packed.vertexCount = (int)(vertices.size() / 8);
+    packed.indexCount = (int)indices.size();
+    packed.vertices = format.pack(vertices, packed.dequantize);
+    packed.positions = format.extractPositions(packed.vertices);
+
+    if (packed.vertexCount <= 65536) {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        packed.indexType = GL_UNSIGNED_SHORT;
+        packed.indices.resize(shortIndices.size() * sizeof(uint16_t));
+        std::memcpy(packed.indices.data(), shortIndices.data(), packed.indices.size());
+    } else {
+        packed.indexType = GL_UNSIGNED_INT;
+        packed.indices.resize(indices.size() * sizeof(unsigned int));
+        std::memcpy(packed.indices.data(), indices.data(), packed.indices.size());
+    }
+    return packed;
+}
+
+Mesh::Mesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const VertexFormat& format)
+    : Mesh(pack(vertices, indices, format).view())
+{
+}
+
+Mesh::Mesh(const PackedMeshView& packed)
+    : format(packed.format), vertexCount(packed.vertexCount), indexCount(packed.indexCount), indexType(packed.indexType),
+      vertexStride(packed.format->getStride()), positionStride(packed.format->getPositionStride()),
+      dequantize(packed.dequantize)
+{
+    size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(unsigned int);
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    GGLState->bindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, (size_t)vertexCount * vertexStride, packed.vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (size_t)indexCount * indexSize, packed.indices, GL_STATIC_DRAW);
+
+    packed.format->apply();
+
+    // Depth passes only read positions; they share the index buffer
+    glGenVertexArrays(1, &depthVAO);
+    glGenBuffers(1, &positionVBO);
+
+    GGLState->bindVertexArray(depthVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+    glBufferData(GL_ARRAY_BUFFER, (size_t)vertexCount * positionStride, packed.positions, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    packed.format->applyPositions();
+
+    // Nothing else may touch the new VAOs' element buffer binding
+    GGLState->bindVertexArray(0);
+
+    // Culling compacts visible clusters out of the CPU copy each frame
+    if (packed.meshletCount > 0) {
+        meshlets.assign(packed.meshlets, packed.meshlets + packed.meshletCount);
+        const uint8_t* indexBytes = (const uint8_t*)packed.indices;
+        indexData.assign(indexBytes, indexBytes + (size_t)indexCount * indexSize);
+    }
+}
+
+Mesh::~Mesh() {
+    if (GGLState) {
+        GGLState->forgetVertexArray(VAO);
+        GGLState->forgetVertexArray(depthVAO);
+    }
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteVertexArrays(1, &depthVAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &positionVBO);
+    glDeleteBuffers(1, &EBO);
+}
+
+size_t Mesh::getByteSize() const {
+    return (size_t)vertexCount * (vertexStride + positionStride) + (size_t)indexCount * getIndexSize();
+}
+
+void Mesh::draw() const {
+    GGLState->bindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+
+    trianglesDrawn += indexCount / 3;
+    vertexBytesFetched += (long long)indexCount * vertexStride;
+    drawCalls++;
+}
+
+void Mesh::drawDepth() const {
+    GGLState->bindVertexArray(depthVAO);
+    glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+
+    trianglesDrawn += indexCount / 3;
+    vertexBytesFetched += (long long)indexCount * positionStride;
+    drawCalls++;
+}
+
+void Mesh::drawRange(unsigned int vao, unsigned int buffer, size_t byteOffset, int count, unsigned int stride) const {
+    // The element buffer is VAO state: swap it for the draw and put ours back
+    GGLState->bindVertexArray(vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+    glDrawElements(GL_TRIANGLES, count, indexType, (const void*)byteOffset);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    trianglesDrawn += count / 3;
+    vertexBytesFetched += (long long)count * stride;
+    drawCalls++;
+}
+
+void Mesh::drawIndices(unsigned int buffer, size_t byteOffset, int count) const {
+    drawRange(VAO, buffer, byteOffset, count, vertexStride);
+}
+
+void Mesh::drawDepthIndices(unsigned int buffer, size_t byteOffset, int count) const {
+    drawRange(depthVAO, buffer, byteOffset, count, positionStride);
+}
+
+void Mesh::drawRanges(const std::vector<GLsizei>& counts, const std::vector<const void*>& byteOffsets, bool depthOnly) const {
+    if (counts.empty()) return;
+
+    GGLState->bindVertexArray(depthOnly ? depthVAO : VAO);
+    glMultiDrawElements(GL_TRIANGLES, counts.data(), indexType, byteOffsets.data(), (GLsizei)counts.size());
+
+    long long total = 0;
+    for (GLsizei count : counts) total += count;
+    trianglesDrawn += total / 3;
+    vertexBytesFetched += total * (depthOnly ? positionStride : vertexStride);
+    drawCalls++;
+}
+
+void Mesh::readBack(std::vector<float>& vertices, std::vector<unsigned int>& indices) const {
+    // The copy-read target leaves the VAO's element buffer binding alone
+    std::vector<uint8_t> packed((size_t)vertexCount * vertexStride);
+    glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, packed.size(), packed.data());
+    vertices = format->unpack(packed.data(), vertexCount, dequantize);
+
+    std::vector<uint8_t> indexBytes((size_t)indexCount * getIndexSize());
+    glBindBuffer(GL_COPY_READ_BUFFER, EBO);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, indexBytes.size(), indexBytes.data());
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    indices.resize(indexCount);
+    for (int i = 0; i < indexCount; i++) {
+        if (indexType == GL_UNSIGNED_SHORT) {
+            uint16_t index;
+            std::memcpy(&index, &indexBytes[i * sizeof(uint16_t)], sizeof(index));
+            indices[i] = index;
+        } else {
+            std::memcpy(&indices[i], &indexBytes[i * sizeof(unsigned int)], sizeof(unsigned int));
+        }
+    }
+}
+
+void Mesh::copyVertices(unsigned int buffer, size_t byteOffset) const {
+    glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, byteOffset, (size_t)vertexCount * vertexStride);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
@@ -0,0 +1,274 @@
+#include "MeshBuilder.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+MeshBuilder::Stats MeshBuilder::stats;
+
+// Forsyth's scoring assumes an LRU cache somewhat larger than real hardware FIFOs
+static const int kOptimizeCacheSize = 32;
+
+bool MeshBuilder::VertexKey::operator==(const VertexKey& other) const {
+    return std::memcmp(data, other.data, sizeof(data)) == 0;
+}
+
+size_t MeshBuilder::VertexKeyHash::operator()(const VertexKey& key) const {
+    // FNV-1a over the raw bits; -0.0 and 0.0 stay distinct, which is harmless
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const unsigned char* bytes = (const unsigned char*)key.data;
+    for (size_t i = 0; i < sizeof(key.data); i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return (size_t)hash;
+}
+
+unsigned int MeshBuilder::addVertex(const float* vertex) {
+    inputVertices++;
+
+    VertexKey key;
+    std::memcpy(key.data, vertex, sizeof(key.data));
+
+    auto found = lookup.find(key);
+    if (found != lookup.end())
+        return found->second;
+
+    unsigned int index = (unsigned int)(vertices.size() / kFloatsPerVertex);
+    vertices.insert(vertices.end(), vertex, vertex + kFloatsPerVertex);
+    lookup.emplace(key, index);
+    return index;
+}
+
+void MeshBuilder::addTriangle(unsigned int a, unsigned int b, unsigned int c) {
+    indices.push_back(a);
+    indices.push_back(b);
+    indices.push_back(c);
+}
+
+void MeshBuilder::addTriangleSoup(const float* soup, size_t vertexCount) {
+    for (size_t i = 0; i + 2 < vertexCount; i += 3) {
+        unsigned int a = addVertex(soup + (i + 0) * kFloatsPerVertex);
+        unsigned int b = addVertex(soup + (i + 1) * kFloatsPerVertex);
+        unsigned int c = addVertex(soup + (i + 2) * kFloatsPerVertex);
+        addTriangle(a, b, c);
+    }
+}
+
+void MeshBuilder::addIndexed(const std::vector<float>& source, const std::vector<unsigned int>& sourceIndices) {
+    // Vertices are added on first use, so subsets like LOD levels stay compact
+    std::vector<unsigned int> remap(source.size() / kFloatsPerVertex, ~0u);
+    auto map = [&](unsigned int index) {
+        if (remap[index] == ~0u)
+            remap[index] = addVertex(&source[index * kFloatsPerVertex]);
+        return remap[index];
+    };
+
+    for (size_t i = 0; i + 2 < sourceIndices.size(); i += 3) {
+        unsigned int a = map(sourceIndices[i]);
+        unsigned int b = map(sourceIndices[i + 1]);
+        unsigned int c = map(sourceIndices[i + 2]);
+        addTriangle(a, b, c);
+    }
+}
+
+float MeshBuilder::computeACMR(const std::vector<unsigned int>& indices, int vertexCount, int cacheSize) {
+    if (indices.empty()) return 0.0f;
+
+    // FIFO: a vertex is cached while fewer than cacheSize misses happened since its own
+    std::vector<long long> insertedAt(vertexCount, LLONG_MIN / 2);
+    long long misses = 0;
+    for (unsigned int index : indices) {
+        if (insertedAt[index] < misses - cacheSize) {
+            insertedAt[index] = misses;
+            misses++;
+        }
+    }
+    return (float)misses / (indices.size() / 3);
+}
+
+static float forsythVertexScore(int cachePosition, int liveTriangles) {
+    if (liveTriangles == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // The last triangle's vertices get a fixed score so strips do not just zig-zag
+        if (cachePosition < 3)
+            score = 0.75f;
+        else
+            score = std::pow(1.0f - (float)(cachePosition - 3) / (kOptimizeCacheSize - 3), 1.5f);
+    }
+    // Favour vertices with few triangles left, finishing them off early
+    score += 2.0f * std::pow((float)liveTriangles, -0.5f);
+    return score;
+}
+
+static void forsythOrder(std::vector<unsigned int>& indices, int vertexCount) {
+    int triangleCount = (int)(indices.size() / 3);
+    if (triangleCount == 0) return;
+
+    // Triangles using each vertex; the first liveTriangles[v] entries are not emitted yet
+    std::vector<int> liveTriangles(vertexCount, 0);
+    for (unsigned int index : indices) liveTriangles[index]++;
+
+    std::vector<int> adjacencyStart(vertexCount + 1, 0);
+    for (int v = 0; v < vertexCount; v++)
+        adjacencyStart[v + 1] = adjacencyStart[v] + liveTriangles[v];
+
+    std::vector<int> adjacency(indices.size());
+    std::vector<int> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (int t = 0; t < triangleCount; t++)
+        for (int k = 0; k < 3; k++)
+            adjacency[fill[indices[t * 3 + k]]++] = t;
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (int v = 0; v < vertexCount; v++)
+        vertexScore[v] = forsythVertexScore(-1, liveTriangles[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (int t = 0; t < triangleCount; t++)
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    std::vector<int> cache, nextCache;
+
+    int best = (int)(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+    int scanFrom = 0;
+
+    for (int emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        if (best < 0) {
+            // Nothing in the cache touches a live triangle: take the first one left
+            while (emitted[scanFrom]) scanFrom++;
+            best = scanFrom;
+        }
+
+        emitted[best] = true;
+        const unsigned int* triangle = &indices[best * 3];
+        output.insert(output.end(), triangle, triangle + 3);
+
+        for (int k = 0; k < 3; k++) {
+            int v = (int)triangle[k];
+            int* begin = &adjacency[adjacencyStart[v]];
+            int* last = begin + liveTriangles[v] - 1;
+            std::iter_swap(std::find(begin, last + 1, best), last);
+            liveTriangles[v]--;
+        }
+
+        // LRU update: the triangle's vertices move to the front
+        nextCache.assign(triangle, triangle + 3);
+        for (int v : cache) {
+            if (v != (int)triangle[0] && v != (int)triangle[1] && v != (int)triangle[2])
+                nextCache.push_back(v);
+        }
+        for (size_t i = kOptimizeCacheSize; i < nextCache.size(); i++)
+            cachePosition[nextCache[i]] = -1;
+        for (size_t i = 0; i < nextCache.size(); i++) {
+            int v = nextCache[i];
+            if (i < (size_t)kOptimizeCacheSize) cachePosition[v] = (int)i;
+            vertexScore[v] = forsythVertexScore(cachePosition[v], liveTriangles[v]);
+        }
+
+        // Only triangles around cached vertices changed score; the best of them goes next
+        best = -1;
+        float bestScore = -1.0f;
+        for (int v : nextCache) {
+            for (int i = 0; i < liveTriangles[v]; i++) {
+                int t = adjacency[adjacencyStart[v] + i];
+                float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                triangleScore[t] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+
+        if (nextCache.size() > (size_t)kOptimizeCacheSize)
+            nextCache.resize(kOptimizeCacheSize);
+        cache.swap(nextCache);
+    }
+
+    indices.swap(output);
+}
+
+void MeshBuilder::optimizeTriangleOrder() {
+    forsythOrder(indices, (int)(vertices.size() / kFloatsPerVertex));
+}
+
+// Clustering regroups triangles, so each meshlet is reordered again on its own
+void MeshBuilder::optimizeMeshletOrder(const std::vector<Meshlet>& meshlets) {
+    std::vector<unsigned int> local, global;
+    std::vector<int> remap(vertices.size() / kFloatsPerVertex, -1);
+    for (const Meshlet& meshlet : meshlets) {
+        unsigned int* range = &indices[meshlet.firstIndex];
+        local.clear();
+        global.clear();
+        for (uint32_t i = 0; i < meshlet.indexCount; i++) {
+            if (remap[range[i]] < 0) {
+                remap[range[i]] = (int)global.size();
+                global.push_back(range[i]);
+            }
+            local.push_back((unsigned int)remap[range[i]]);
+        }
+
+        forsythOrder(local, (int)global.size());
+        for (uint32_t i = 0; i < meshlet.indexCount; i++)
+            range[i] = global[local[i]];
+        for (unsigned int v : global) remap[v] = -1;
+    }
+}
+
+// Renumbers vertices in the order the index buffer first touches them, so
+// vertex fetches walk the buffer mostly forwards
+void MeshBuilder::optimizeVertexOrder() {
+    int vertexCount = (int)(vertices.size() / kFloatsPerVertex);
+    std::vector<int> remap(vertexCount, -1);
+    std::vector<float> reordered;
+    reordered.reserve(vertices.size());
+
+    int next = 0;
+    for (unsigned int& index : indices) {
+        if (remap[index] < 0) {
+            remap[index] = next++;
+            reordered.insert(reordered.end(), &vertices[index * kFloatsPerVertex], &vertices[(index + 1) * kFloatsPerVertex]);
+        }
+        index = (unsigned int)remap[index];
+    }
+    vertices.swap(reordered);
+}
+
+std::shared_ptr<Mesh> MeshBuilder::build() {
+    PackedMesh packed = buildPacked();
+    return std::make_shared<Mesh>(packed.view());
+}
+
+PackedMesh MeshBuilder::buildPacked(const VertexFormat& format, int meshletTriangles) {
+    int vertexCount = (int)(vertices.size() / kFloatsPerVertex);
+    size_t triangleCount = indices.size() / 3;
+
+    float acmrBefore = computeACMR(indices, vertexCount);
+    optimizeTriangleOrder();
+    // Clusters regroup triangles, so they come before vertices are renumbered by first use
+    std::vector<Meshlet> meshlets;
+    if (meshletTriangles > 0 && (int)triangleCount > meshletTriangles) {
+        meshlets = buildMeshlets(vertices, indices, meshletTriangles);
+        optimizeMeshletOrder(meshlets);
+    }
+    optimizeVertexOrder();
+    float acmrAfter = computeACMR(indices, (int)(vertices.size() / kFloatsPerVertex));
+
+    stats.meshes++;
+    stats.inputVertices += (long long)inputVertices;
+    stats.vertices += (long long)(vertices.size() / kFloatsPerVertex);
+    stats.triangles += (long long)triangleCount;
+    stats.missesBefore += acmrBefore * triangleCount;
+    stats.missesAfter += acmrAfter * triangleCount;
+
+    PackedMesh packed = Mesh::pack(vertices, indices, format);
+    packed.meshlets = std::move(meshlets);
+    stats.vertexBytes += packed.vertices.size();
+    return packed;
+}
@@ -0,0 +1,1073 @@
+#include "MeshImporter.h"
+#include "CookedTexture.h"
+#include "Json.h"
+#include "MappedFile.h"
+#include "MeshBuilder.h"
+#include "MeshSimplifier.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+MeshImporter* GMeshImporter = nullptr;
+
+static const uint32_t kMeshCacheMagic   = 0x48534D45; // "EMSH"
+static const uint32_t kMeshCacheVersion = 4;
+static const uint32_t kNoString = 0xFFFFFFFFu;
+
+// Cache layout: header, parts, materials, dependency string offsets, string
+// blob, then the 16-byte aligned vertex/position/index blocks of every part.
+// A part's simplified levels follow it directly, with lodLevel counting up from 1.
+// Meshlet tables are stored with the data blocks, read in place like them.
+struct MeshCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t formatKey;
+    uint32_t partCount;
+    uint32_t materialCount;
+    uint32_t dependencyCount;
+    uint32_t stringBytes;
+    uint32_t settingsKey;       // LOD and meshlet settings the parts were made with
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct MeshCachePart {
+    int32_t material;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexType;
+    uint32_t lodLevel;
+    float lodError;
+    uint32_t meshletCount;
+    uint32_t reserved;
+    uint64_t vertexOffset;
+    uint64_t positionOffset;
+    uint64_t indexOffset;
+    uint64_t meshletOffset;
+    float dequantize[16];
+};
+
+struct MeshCacheMaterial {
+    float baseColor[3];
+    uint32_t nameOffset;
+    uint32_t albedoOffset;
+    uint32_t flags;
+};
+
+static const uint32_t kMaterialDoubleSided = 1;
+
+static_assert(sizeof(Meshlet) == 40, "Meshlet is stored in the mesh cache as is");
+
+// One packed mesh on its way into the cache
+struct PackedPart {
+    PackedMesh mesh;
+    int material = -1;
+    uint32_t lodLevel = 0;
+    float lodError = 0.0f;
+};
+
+// Parsed source before packing: one builder per material
+struct SourceModel {
+    std::vector<ImportedMaterial> materials;
+    std::vector<MeshBuilder> builders;
+    std::vector<std::string> dependencies;
+    glm::vec3 boundsMin = glm::vec3(INFINITY);
+    glm::vec3 boundsMax = glm::vec3(-INFINITY);
+
+    int defaultMaterial() {
+        for (size_t i = 0; i < materials.size(); i++)
+            if (materials[i].name == "__default") return (int)i;
+        ImportedMaterial material;
+        material.name = "__default";
+        materials.push_back(material);
+        return (int)materials.size() - 1;
+    }
+
+    // Vertices are pos(3), normal(3), uv(2); a zero normal gets the face normal
+    void addTriangle(int material, float (&v)[3][8]) {
+        if ((int)builders.size() <= material) builders.resize(material + 1);
+
+        glm::vec3 p0(v[0][0], v[0][1], v[0][2]), p1(v[1][0], v[1][1], v[1][2]), p2(v[2][0], v[2][1], v[2][2]);
+        glm::vec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(faceNormal);
+        faceNormal = (length > 0.0f) ? faceNormal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+
+        unsigned int index[3];
+        for (int k = 0; k < 3; k++) {
+            if (v[k][3] == 0.0f && v[k][4] == 0.0f && v[k][5] == 0.0f) {
+                v[k][3] = faceNormal.x;
+                v[k][4] = faceNormal.y;
+                v[k][5] = faceNormal.z;
+            }
+            glm::vec3 p(v[k][0], v[k][1], v[k][2]);
+            boundsMin = glm::min(boundsMin, p);
+            boundsMax = glm::max(boundsMax, p);
+            index[k] = builders[material].addVertex(v[k]);
+        }
+        builders[material].addTriangle(index[0], index[1], index[2]);
+    }
+};
+
+static bool readWholeFile(const std::string& path, std::vector<char>& data) {
+    std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+    std::streamsize size = file.tellg();
+    file.seekg(0);
+    data.resize((size_t)size);
+    return (bool)file.read(data.data(), size);
+}
+
+static std::string resolveRelative(const std::string& base, const std::string& relative) {
+    std::filesystem::path path = std::filesystem::path(base).parent_path() / relative;
+    return path.lexically_normal().generic_string();
+}
+
+// ---------------------------------------------------------------- OBJ
+
+static const char* skipSpaces(const char* at, const char* end) {
+    while (at < end && (*at == ' ' || *at == '\t')) at++;
+    return at;
+}
+
+static std::string restOfLine(const char* at, const char* end) {
+    at = skipSpaces(at, end);
+    const char* last = end;
+    while (last > at && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r')) last--;
+    return std::string(at, last);
+}
+
+static void loadMtl(const std::string& path, SourceModel& model) {
+    std::vector<char> text;
+    if (!readWholeFile(path, text)) {
+        std::cout << "ERROR::MESH_IMPORTER:: Cannot read material library " << path << std::endl;
+        return;
+    }
+    text.push_back('\0');     // strtof may look past the last line
+    model.dependencies.push_back(path);
+
+    ImportedMaterial* current = nullptr;
+    const char* at = text.data();
+    const char* end = at + text.size() - 1;
+    while (at < end) {
+        const char* lineEnd = (const char*)std::memchr(at, '\n', end - at);
+        if (!lineEnd) lineEnd = end;
+        const char* word = skipSpaces(at, lineEnd);
+
+        if (lineEnd - word > 7 && std::strncmp(word, "newmtl ", 7) == 0) {
+            ImportedMaterial material;
+            material.name = restOfLine(word + 7, lineEnd);
+            model.materials.push_back(material);
+            current = &model.materials.back();
+        } else if (current && lineEnd - word > 3 && std::strncmp(word, "Kd ", 3) == 0) {
+            char* next = (char*)word + 3;
+            for (int c = 0; c < 3; c++)
+                current->baseColor[c] = std::strtof(next, &next);
+        } else if (current && lineEnd - word > 7 && std::strncmp(word, "map_Kd ", 7) == 0) {
+            // Options like -s 1 1 1 come first; the file name is the last token
+            std::string value = restOfLine(word + 7, lineEnd);
+            size_t split = value.find_last_of(" \t");
+            std::string file = (split == std::string::npos) ? value : value.substr(split + 1);
+            current->albedoPath = resolveRelative(path, file);
+        }
+        at = lineEnd + 1;
+    }
+}
+
+static bool importObj(const std::string& path, SourceModel& model) {
+    std::vector<char> text;
+    if (!readWholeFile(path, text)) {
+        std::cout << "ERROR::MESH_IMPORTER:: Cannot read " << path << std::endl;
+        return false;
+    }
+    text.push_back('\0');     // strtof may look past the last line
+
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> texCoords;
+    int material = -1;
+
+    // Corner as (position, uv, normal), 1-based, 0 = absent
+    std::vector<int> corners;
+
+    const char* at = text.data();
+    const char* end = at + text.size() - 1;
+    while (at < end) {
+        const char* lineEnd = (const char*)std::memchr(at, '\n', end - at);
+        if (!lineEnd) lineEnd = end;
+        const char* word = skipSpaces(at, lineEnd);
+        char* next = nullptr;
+
+        if (lineEnd - word > 2 && word[0] == 'v' && word[1] == ' ') {
+            next = (char*)word + 2;
+            glm::vec3 p;
+            for (int c = 0; c < 3; c++) p[c] = std::strtof(next, &next);
+            positions.push_back(p);
+        } else if (lineEnd - word > 3 && word[0] == 'v' && word[1] == 't' && word[2] == ' ') {
+            next = (char*)word + 3;
+            glm::vec2 uv;
+            uv.x = std::strtof(next, &next);
+            uv.y = std::strtof(next, &next);
+            texCoords.push_back(uv);
+        } else if (lineEnd - word > 3 && word[0] == 'v' && word[1] == 'n' && word[2] == ' ') {
+            next = (char*)word + 3;
+            glm::vec3 n;
+            for (int c = 0; c < 3; c++) n[c] = std::strtof(next, &next);
+            normals.push_back(n);
+        } else if (lineEnd - word > 2 && word[0] == 'f' && word[1] == ' ') {
+            corners.clear();
+            const char* token = word + 2;
+            while (true) {
+                token = skipSpaces(token, lineEnd);
+                if (token >= lineEnd || *token == '\r' || *token == '#') break;
+
+                int values[3] = { 0, 0, 0 };
+                int counts[3] = { (int)positions.size(), (int)texCoords.size(), (int)normals.size() };
+                for (int k = 0; k < 3 && token < lineEnd; k++) {
+                    if (*token != '/') {
+                        long value = std::strtol(token, &next, 10);
+                        if (next == token) break;
+                        // Negative indices count back from the latest element
+                        values[k] = (value < 0) ? counts[k] + (int)value + 1 : (int)value;
+                        token = next;
+                    }
+                    if (token < lineEnd && *token == '/') token++;
+                    else break;
+                }
+                while (token < lineEnd && *token != ' ' && *token != '\t' && *token != '\r') token++;
+                corners.insert(corners.end(), values, values + 3);
+            }
+
+            // Fan triangulation; faces are convex in practice
+            int cornerCount = (int)corners.size() / 3;
+            for (int i = 1; i + 1 < cornerCount; i++) {
+                int triangle[3] = { 0, i, i + 1 };
+                float v[3][8] = {};
+                bool valid = true;
+                for (int k = 0; k < 3; k++) {
+                    const int* corner = &corners[triangle[k] * 3];
+                    if (corner[0] < 1 || corner[0] > (int)positions.size()) { valid = false; break; }
+                    const glm::vec3& p = positions[corner[0] - 1];
+                    v[k][0] = p.x; v[k][1] = p.y; v[k][2] = p.z;
+                    if (corner[2] >= 1 && corner[2] <= (int)normals.size()) {
+                        glm::vec3 n = glm::normalize(normals[corner[2] - 1]);
+                        v[k][3] = n.x; v[k][4] = n.y; v[k][5] = n.z;
+                    }
+                    if (corner[1] >= 1 && corner[1] <= (int)texCoords.size()) {
+                        v[k][6] = texCoords[corner[1] - 1].x;
+                        v[k][7] = texCoords[corner[1] - 1].y;
+                    }
+                }
+                if (!valid) continue;
+                if (material < 0) material = model.defaultMaterial();
+                model.addTriangle(material, v);
+            }
+        } else if (lineEnd - word > 7 && std::strncmp(word, "mtllib ", 7) == 0) {
+            loadMtl(resolveRelative(path, restOfLine(word + 7, lineEnd)), model);
+        } else if (lineEnd - word > 7 && std::strncmp(word, "usemtl ", 7) == 0) {
+            std::string name = restOfLine(word + 7, lineEnd);
+            material = -1;
+            for (size_t i = 0; i < model.materials.size(); i++)
+                if (model.materials[i].name == name) material = (int)i;
+        }
+        at = lineEnd + 1;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- glTF
+
+static const uint32_t kGlbMagic     = 0x46546C67; // "glTF"
+static const uint32_t kGlbChunkJson = 0x4E4F534A;
+static const uint32_t kGlbChunkBin  = 0x004E4942;
+
+static std::string decodeUri(const std::string& uri) {
+    std::string out;
+    for (size_t i = 0; i < uri.size(); i++) {
+        if (uri[i] == '%' && i + 2 < uri.size()) {
+            out += (char)std::strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        } else {
+            out += uri[i];
+        }
+    }
+    return out;
+}
+
+static bool decodeBase64(const char* at, const char* end, std::vector<uint8_t>& out) {
+    auto value = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    };
+
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (; at < end && *at != '='; at++) {
+        int v = value(*at);
+        if (v < 0) return false;
+        bits = (bits << 6) | (uint32_t)v;
+        bitCount += 6;
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            out.push_back((uint8_t)(bits >> bitCount));
+        }
+    }
+    return true;
+}
+
+struct GltfBuffer {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::vector<uint8_t> storage;
+};
+
+struct GltfDocument {
+    std::string path;
+    JsonValue json;
+    std::vector<GltfBuffer> buffers;
+
+    // Element e, component c of an accessor, converted to float
+    bool readAccessor(int index, int components, std::vector<float>& out) const;
+    bool readIndices(int index, std::vector<unsigned int>& out) const;
+    bool accessorData(int index, const uint8_t*& data, size_t& stride, int& componentType, int& count, int components) const;
+};
+
+static int componentCountOf(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+static size_t componentSizeOf(int componentType) {
+    switch (componentType) {
+        case 5120: case 5121: return 1;     // BYTE, UNSIGNED_BYTE
+        case 5122: case 5123: return 2;     // SHORT, UNSIGNED_SHORT
+        case 5125: case 5126: return 4;     // UNSIGNED_INT, FLOAT
+    }
+    return 0;
+}
+
+bool GltfDocument::accessorData(int index, const uint8_t*& data, size_t& stride, int& componentType, int& count, int components) const {
+    const JsonValue& accessor = json["accessors"][index];
+    if (accessor.isNull()) return false;
+
+    componentType = accessor["componentType"].asInt();
+    count = accessor["count"].asInt(0);
+    int accessorComponents = componentCountOf(accessor["type"].asString());
+    size_t componentSize = componentSizeOf(componentType);
+    if (componentSize == 0 || accessorComponents < components || count < 0) return false;
+
+    if (accessor.has("sparse"))
+        std::cout << "ERROR::MESH_IMPORTER:: Sparse accessors are not supported, using base values in " << path << std::endl;
+
+    const JsonValue& view = json["bufferViews"][accessor["bufferView"].asInt()];
+    if (view.isNull()) {
+        data = nullptr;     // all zeros per spec
+        stride = 0;
+        return true;
+    }
+
+    int bufferIndex = view["buffer"].asInt();
+    if (bufferIndex < 0 || bufferIndex >= (int)buffers.size()) return false;
+    const GltfBuffer& buffer = buffers[bufferIndex];
+
+    size_t elementSize = componentSize * accessorComponents;
+    stride = (size_t)view["byteStride"].asNumber(0.0);
+    if (stride == 0) stride = elementSize;
+
+    size_t offset = (size_t)view["byteOffset"].asNumber(0.0) + (size_t)accessor["byteOffset"].asNumber(0.0);
+    size_t viewEnd = (size_t)view["byteOffset"].asNumber(0.0) + (size_t)view["byteLength"].asNumber(0.0);
+    size_t needed = (count > 0) ? offset + stride * (count - 1) + elementSize : offset;
+    if (needed > viewEnd || viewEnd > buffer.size) return false;
+
+    data = buffer.data + offset;
+    return true;
+}
+
+bool GltfDocument::readAccessor(int index, int components, std::vector<float>& out) const {
+    const uint8_t* data;
+    size_t stride;
+    int componentType, count;
+    if (!accessorData(index, data, stride, componentType, count, components)) return false;
+
+    bool normalized = json["accessors"][index]["normalized"].boolean;
+    out.assign((size_t)count * components, 0.0f);
+    if (!data) return true;
+
+    for (int e = 0; e < count; e++) {
+        const uint8_t* element = data + (size_t)e * stride;
+        for (int c = 0; c < components; c++) {
+            float value = 0.0f;
+            switch (componentType) {
+                case 5126: { float v; std::memcpy(&v, element + c * 4, 4); value = v; break; }
+                case 5120: { int8_t v = (int8_t)element[c]; value = normalized ? std::max(v / 127.0f, -1.0f) : v; break; }
+                case 5121: { uint8_t v = element[c]; value = normalized ? v / 255.0f : v; break; }
+                case 5122: { int16_t v; std::memcpy(&v, element + c * 2, 2); value = normalized ? std::max(v / 32767.0f, -1.0f) : v; break; }
+                case 5123: { uint16_t v; std::memcpy(&v, element + c * 2, 2); value = normalized ? v / 65535.0f : v; break; }
+                case 5125: { uint32_t v; std::memcpy(&v, element + c * 4, 4); value = (float)v; break; }
+            }
+            out[(size_t)e * components + c] = value;
+        }
+    }
+    return true;
+}
+
+bool GltfDocument::readIndices(int index, std::vector<unsigned int>& out) const {
+    const uint8_t* data;
+    size_t stride;
+    int componentType, count;
+    if (!accessorData(index, data, stride, componentType, count, 1)) return false;
+
+    out.assign(count, 0);
+    if (!data) return true;
+    for (int i = 0; i < count; i++) {
+        const uint8_t* element = data + (size_t)i * stride;
+        switch (componentType) {
+            case 5121: out[i] = element[0]; break;
+            case 5123: { uint16_t v; std::memcpy(&v, element, 2); out[i] = v; break; }
+            case 5125: { uint32_t v; std::memcpy(&v, element, 4); out[i] = v; break; }
+            default: return false;
+        }
+    }
+    return true;
+}
+
+static glm::mat4 nodeTransform(const JsonValue& node) {
+    const JsonValue& matrix = node["matrix"];
+    if (matrix.size() == 16) {
+        glm::mat4 m;
+        for (int i = 0; i < 16; i++) m[i / 4][i % 4] = (float)matrix[i].asNumber();
+        return m;
+    }
+
+    glm::vec3 t(0.0f), s(1.0f);
+    float q[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    for (int i = 0; i < 3; i++) {
+        t[i] = (float)node["translation"][i].asNumber(0.0);
+        s[i] = (float)node["scale"][i].asNumber(1.0);
+    }
+    for (int i = 0; i < 4; i++)
+        q[i] = (float)node["rotation"][i].asNumber(q[i]);
+
+    // T * R * S with R from the unit quaternion (x, y, z, w)
+    float x = q[0], y = q[1], z = q[2], w = q[3];
+    glm::mat4 m(1.0f);
+    m[0] = glm::vec4(1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w), 0.0f) * s.x;
+    m[1] = glm::vec4(2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w), 0.0f) * s.y;
+    m[2] = glm::vec4(2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y), 0.0f) * s.z;
+    m[3] = glm::vec4(t, 1.0f);
+    return m;
+}
+
+static void importGltfMesh(const GltfDocument& doc, int meshIndex, const glm::mat4& transform,
+                           const std::vector<int>& materialMap, SourceModel& model) {
+    const JsonValue& primitives = doc.json["meshes"][meshIndex]["primitives"];
+
+    glm::mat3 linear(transform);
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+    // Mirroring transforms flip the winding
+    bool flip = glm::dot(linear[0], glm::cross(linear[1], linear[2])) < 0.0f;
+
+    for (size_t p = 0; p < primitives.size(); p++) {
+        const JsonValue& primitive = primitives[p];
+        int mode = primitive["mode"].asInt(4);
+        if (mode != 4) {
+            std::cout << "ERROR::MESH_IMPORTER:: Skipping non-triangle primitive (mode " << mode << ") in " << doc.path << std::endl;
+            continue;
+        }
+
+        const JsonValue& attributes = primitive["attributes"];
+        std::vector<float> positions, normals, texCoords;
+        if (!doc.readAccessor(attributes["POSITION"].asInt(), 3, positions)) {
+            std::cout << "ERROR::MESH_IMPORTER:: Primitive without readable POSITION in " << doc.path << std::endl;
+            continue;
+        }
+        size_t vertexCount = positions.size() / 3;
+        if (attributes.has("NORMAL") && (!doc.readAccessor(attributes["NORMAL"].asInt(), 3, normals) || normals.size() != vertexCount * 3))
+            normals.clear();
+        if (attributes.has("TEXCOORD_0") && (!doc.readAccessor(attributes["TEXCOORD_0"].asInt(), 2, texCoords) || texCoords.size() != vertexCount * 2))
+            texCoords.clear();
+
+        std::vector<unsigned int> indices;
+        if (primitive.has("indices")) {
+            if (!doc.readIndices(primitive["indices"].asInt(), indices)) {
+                std::cout << "ERROR::MESH_IMPORTER:: Unreadable indices in " << doc.path << std::endl;
+                continue;
+            }
+        } else {
+            indices.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++) indices[i] = (unsigned int)i;
+        }
+
+        int materialIndex = primitive["material"].asInt();
+        int material = (materialIndex >= 0 && materialIndex < (int)materialMap.size())
+                     ? materialMap[materialIndex] : model.defaultMaterial();
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            float v[3][8] = {};
+            bool valid = true;
+            for (int k = 0; k < 3; k++) {
+                unsigned int index = indices[i + (flip ? 2 - k : k)];
+                if (index >= vertexCount) { valid = false; break; }
+
+                glm::vec4 p = transform * glm::vec4(positions[index * 3], positions[index * 3 + 1], positions[index * 3 + 2], 1.0f);
+                v[k][0] = p.x; v[k][1] = p.y; v[k][2] = p.z;
+                if (!normals.empty()) {
+                    glm::vec3 n = normalMatrix * glm::vec3(normals[index * 3], normals[index * 3 + 1], normals[index * 3 + 2]);
+                    float length = glm::length(n);
+                    if (length > 0.0f) n /= length;
+                    v[k][3] = n.x; v[k][4] = n.y; v[k][5] = n.z;
+                }
+                if (!texCoords.empty()) {
+                    // glTF puts the UV origin top-left; our images are flipped on load
+                    v[k][6] = texCoords[index * 2];
+                    v[k][7] = 1.0f - texCoords[index * 2 + 1];
+                }
+            }
+            if (valid) model.addTriangle(material, v);
+        }
+    }
+}
+
+static bool loadGltfBuffers(GltfDocument& doc, const uint8_t* glbBin, size_t glbBinSize, SourceModel& model) {
+    const JsonValue& buffers = doc.json["buffers"];
+    doc.buffers.resize(buffers.size());
+
+    for (size_t i = 0; i < buffers.size(); i++) {
+        GltfBuffer& buffer = doc.buffers[i];
+        const JsonValue& uri = buffers[i]["uri"];
+
+        if (uri.isNull()) {
+            // GLB: the first buffer without a uri is the BIN chunk
+            if (i != 0 || !glbBin) {
+                std::cout << "ERROR::MESH_IMPORTER:: Buffer " << i << " has no data in " << doc.path << std::endl;
+                return false;
+            }
+            buffer.data = glbBin;
+            buffer.size = glbBinSize;
+            continue;
+        }
+
+        const std::string& value = uri.asString();
+        if (value.compare(0, 5, "data:") == 0) {
+            size_t comma = value.find(',');
+            if (comma == std::string::npos || value.find(";base64") > comma ||
+                !decodeBase64(value.data() + comma + 1, value.data() + value.size(), buffer.storage)) {
+                std::cout << "ERROR::MESH_IMPORTER:: Bad data URI in buffer " << i << " of " << doc.path << std::endl;
+                return false;
+            }
+        } else if (value.find("://") != std::string::npos) {
+            std::cout << "ERROR::MESH_IMPORTER:: Only local files are supported: " << value << std::endl;
+            return false;
+        } else {
+            std::string bufferPath = resolveRelative(doc.path, decodeUri(value));
+            std::vector<char> bytes;
+            if (!readWholeFile(bufferPath, bytes)) {
+                std::cout << "ERROR::MESH_IMPORTER:: Cannot read buffer " << bufferPath << std::endl;
+                return false;
+            }
+            buffer.storage.assign(bytes.begin(), bytes.end());
+            model.dependencies.push_back(bufferPath);
+        }
+        buffer.data = buffer.storage.data();
+        buffer.size = buffer.storage.size();
+    }
+    return true;
+}
+
+static bool importGltf(const std::string& path, SourceModel& model) {
+    std::vector<char> file;
+    if (!readWholeFile(path, file)) {
+        std::cout << "ERROR::MESH_IMPORTER:: Cannot read " << path << std::endl;
+        return false;
+    }
+
+    GltfDocument doc;
+    doc.path = path;
+
+    const char* jsonText = file.data();
+    size_t jsonLength = file.size();
+    const uint8_t* bin = nullptr;
+    size_t binSize = 0;
+
+    uint32_t magic = 0;
+    if (file.size() >= 12) std::memcpy(&magic, file.data(), 4);
+    if (magic == kGlbMagic) {
+        // 12-byte header, then (length, type, data) chunks: JSON first, optional BIN
+        size_t offset = 12;
+        jsonText = nullptr;
+        while (offset + 8 <= file.size()) {
+            uint32_t chunkLength, chunkType;
+            std::memcpy(&chunkLength, file.data() + offset, 4);
+            std::memcpy(&chunkType, file.data() + offset + 4, 4);
+            offset += 8;
+            if (offset + chunkLength > file.size()) break;
+            if (chunkType == kGlbChunkJson && !jsonText) {
+                jsonText = file.data() + offset;
+                jsonLength = chunkLength;
+            } else if (chunkType == kGlbChunkBin && !bin) {
+                bin = (const uint8_t*)file.data() + offset;
+                binSize = chunkLength;
+            }
+            offset += (chunkLength + 3) & ~3u;
+        }
+        if (!jsonText) {
+            std::cout << "ERROR::MESH_IMPORTER:: GLB without a JSON chunk: " << path << std::endl;
+            return false;
+        }
+        // JSON chunks are padded with spaces, but tolerate trailing zeros too
+        while (jsonLength > 0 && jsonText[jsonLength - 1] == '\0') jsonLength--;
+    }
+
+    std::string error;
+    if (!parseJson(jsonText, jsonLength, doc.json, error)) {
+        std::cout << "ERROR::MESH_IMPORTER:: Bad glTF JSON in " << path << ": " << error << std::endl;
+        return false;
+    }
+    if (doc.json["asset"]["version"].asString().compare(0, 2, "2.") != 0) {
+        std::cout << "ERROR::MESH_IMPORTER:: Only glTF 2.0 is supported: " << path << std::endl;
+        return false;
+    }
+    if (!loadGltfBuffers(doc, bin, binSize, model))
+        return false;
+
+    // Materials: base color factor and texture; other PBR maps are not used by the shaders
+    const JsonValue& materials = doc.json["materials"];
+    std::vector<int> materialMap;
+    for (size_t i = 0; i < materials.size(); i++) {
+        const JsonValue& pbr = materials[i]["pbrMetallicRoughness"];
+        ImportedMaterial material;
+        material.name = materials[i]["name"].asString();
+        for (int c = 0; c < 3; c++)
+            material.baseColor[c] = (float)pbr["baseColorFactor"][c].asNumber(1.0);
+        material.doubleSided = materials[i]["doubleSided"].asBool();
+
+        const JsonValue& texture = doc.json["textures"][pbr["baseColorTexture"]["index"].asInt()];
+        const JsonValue& image = doc.json["images"][texture["source"].asInt()];
+        const std::string& uri = image["uri"].asString();
+        if (!uri.empty() && uri.compare(0, 5, "data:") != 0 && uri.find("://") == std::string::npos)
+            material.albedoPath = resolveRelative(path, decodeUri(uri));
+        else if (!image.isNull())
+            std::cout << "ERROR::MESH_IMPORTER:: Embedded images are not supported, material "
+                      << material.name << " in " << path << std::endl;
+
+        materialMap.push_back((int)model.materials.size());
+        model.materials.push_back(material);
+    }
+
+    // Walk the default scene, or every root node when there is none
+    const JsonValue& nodes = doc.json["nodes"];
+    std::vector<int> roots;
+    const JsonValue& scene = doc.json["scenes"][doc.json["scene"].asInt(0)];
+    if (!scene.isNull()) {
+        for (size_t i = 0; i < scene["nodes"].size(); i++) roots.push_back(scene["nodes"][i].asInt());
+    } else {
+        std::vector<bool> isChild(nodes.size(), false);
+        for (size_t i = 0; i < nodes.size(); i++)
+            for (size_t c = 0; c < nodes[i]["children"].size(); c++) {
+                int child = nodes[i]["children"][c].asInt();
+                if (child >= 0 && child < (int)nodes.size()) isChild[child] = true;
+            }
+        for (size_t i = 0; i < nodes.size(); i++)
+            if (!isChild[i]) roots.push_back((int)i);
+    }
+
+    std::vector<std::pair<int, glm::mat4>> stack;
+    for (int root : roots) stack.emplace_back(root, glm::mat4(1.0f));
+    size_t visited = 0;
+    while (!stack.empty() && visited++ < nodes.size() * 4 + 16) {
+        auto [index, parent] = stack.back();
+        stack.pop_back();
+        const JsonValue& node = nodes[index];
+        if (node.isNull()) continue;
+
+        glm::mat4 world = parent * nodeTransform(node);
+        if (node.has("mesh"))
+            importGltfMesh(doc, node["mesh"].asInt(), world, materialMap, model);
+        for (size_t c = 0; c < node["children"].size(); c++)
+            stack.emplace_back(node["children"][c].asInt(), world);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- cache
+
+std::string MeshImporter::cachePathFor(const std::string& sourcePath) {
+    // The stem keeps cache files recognisable, the hash keeps same-named models apart
+    uint32_t hash = 2166136261u;
+    for (char c : std::filesystem::path(sourcePath).lexically_normal().generic_string()) {
+        hash ^= (uint8_t)c;
+        hash *= 16777619u;
+    }
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "-%08x.mesh", hash);
+    return (std::filesystem::path("cache/meshes") / std::filesystem::path(sourcePath).stem()).string() + suffix;
+}
+
+static size_t alignTo16(size_t value) {
+    return (value + 15) & ~(size_t)15;
+}
+
+static bool writeMeshCache(const std::string& path, const SourceModel& source, const std::vector<PackedPart>& packed,
+                           uint32_t settingsKey) {
+    std::string strings;
+    auto addString = [&strings](const std::string& value) -> uint32_t {
+        if (value.empty()) return kNoString;
+        uint32_t offset = (uint32_t)strings.size();
+        strings += value;
+        strings += '\0';
+        return offset;
+    };
+
+    std::vector<MeshCacheMaterial> materials(source.materials.size());
+    for (size_t i = 0; i < materials.size(); i++) {
+        for (int c = 0; c < 3; c++) materials[i].baseColor[c] = source.materials[i].baseColor[c];
+        materials[i].nameOffset = addString(source.materials[i].name);
+        materials[i].albedoOffset = addString(source.materials[i].albedoPath);
+        materials[i].flags = source.materials[i].doubleSided ? kMaterialDoubleSided : 0;
+    }
+    std::vector<uint32_t> dependencies;
+    for (const std::string& dependency : source.dependencies)
+        dependencies.push_back(addString(dependency));
+
+    MeshCacheHeader header{};
+    header.magic = kMeshCacheMagic;
+    header.version = kMeshCacheVersion;
+    header.formatKey = VertexFormat::getDefault().getKey();
+    header.partCount = (uint32_t)packed.size();
+    header.materialCount = (uint32_t)materials.size();
+    header.dependencyCount = (uint32_t)dependencies.size();
+    header.stringBytes = (uint32_t)strings.size();
+    header.settingsKey = settingsKey;
+    for (int c = 0; c < 3; c++) {
+        header.boundsMin[c] = source.boundsMin[c];
+        header.boundsMax[c] = source.boundsMax[c];
+    }
+
+    size_t offset = alignTo16(sizeof(header) + packed.size() * sizeof(MeshCachePart) +
+                              materials.size() * sizeof(MeshCacheMaterial) +
+                              dependencies.size() * sizeof(uint32_t) + strings.size());
+
+    std::vector<MeshCachePart> parts(packed.size());
+    for (size_t i = 0; i < packed.size(); i++) {
+        const PackedMesh& mesh = packed[i].mesh;
+        MeshCachePart& part = parts[i];
+        part.material = packed[i].material;
+        part.vertexCount = (uint32_t)mesh.vertexCount;
+        part.indexCount = (uint32_t)mesh.indexCount;
+        part.indexType = (uint32_t)mesh.indexType;
+        part.lodLevel = packed[i].lodLevel;
+        part.lodError = packed[i].lodError;
+        part.meshletCount = (uint32_t)mesh.meshlets.size();
+        part.reserved = 0;
+        for (int k = 0; k < 16; k++) part.dequantize[k] = mesh.dequantize[k / 4][k % 4];
+
+        part.vertexOffset = offset;
+        offset = alignTo16(offset + mesh.vertices.size());
+        part.positionOffset = offset;
+        offset = alignTo16(offset + mesh.positions.size());
+        part.indexOffset = offset;
+        offset = alignTo16(offset + mesh.indices.size());
+        part.meshletOffset = offset;
+        offset = alignTo16(offset + mesh.meshlets.size() * sizeof(Meshlet));
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "ERROR::MESH_IMPORTER:: Cannot write " << path << std::endl;
+        return false;
+    }
+
+    auto padTo = [&file](size_t target) {
+        static const char zeros[16] = {};
+        size_t position = (size_t)file.tellp();
+        if (target > position) file.write(zeros, target - position);
+    };
+
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)parts.data(), parts.size() * sizeof(MeshCachePart));
+    file.write((const char*)materials.data(), materials.size() * sizeof(MeshCacheMaterial));
+    file.write((const char*)dependencies.data(), dependencies.size() * sizeof(uint32_t));
+    file.write(strings.data(), strings.size());
+    for (size_t i = 0; i < packed.size(); i++) {
+        const PackedMesh& mesh = packed[i].mesh;
+        padTo(parts[i].vertexOffset);
+        file.write((const char*)mesh.vertices.data(), mesh.vertices.size());
+        padTo(parts[i].positionOffset);
+        file.write((const char*)mesh.positions.data(), mesh.positions.size());
+        padTo(parts[i].indexOffset);
+        file.write((const char*)mesh.indices.data(), mesh.indices.size());
+        padTo(parts[i].meshletOffset);
+        file.write((const char*)mesh.meshlets.data(), mesh.meshlets.size() * sizeof(Meshlet));
+    }
+    return (bool)file;
+}
+
+// Level 0 starts a new part, simplified levels extend the last one
+static void addPart(ImportedModel& model, std::shared_ptr<Mesh> mesh, int material, uint32_t lodLevel, float lodError) {
+    if (lodLevel == 0 || model.parts.empty()) {
+        ImportedPart part;
+        part.mesh = mesh;
+        part.material = material;
+        model.parts.push_back(part);
+    } else {
+        model.parts.back().lods.push_back({ mesh, lodError });
+    }
+}
+
+// Uploads straight from the mapping; false when the cache is missing, stale or foreign
+static bool readMeshCache(const std::string& sourcePath, const std::string& cachePath, uint32_t settingsKey,
+                          ImportedModel& model) {
+    if (!isCookedUpToDate(sourcePath, cachePath))
+        return false;
+
+    MappedFile file;
+    if (!file.open(cachePath))
+        return false;
+
+    const uint8_t* data = file.getData();
+    size_t size = file.getSize();
+
+    MeshCacheHeader header;
+    if (size < sizeof(header)) return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kMeshCacheMagic || header.version != kMeshCacheVersion)
+        return false;
+    // Written for another vertex layout (--full-vertices): import again
+    if (header.formatKey != VertexFormat::getDefault().getKey() || header.settingsKey != settingsKey)
+        return false;
+
+    size_t tablesSize = sizeof(header) + (size_t)header.partCount * sizeof(MeshCachePart) +
+                        (size_t)header.materialCount * sizeof(MeshCacheMaterial) +
+                        (size_t)header.dependencyCount * sizeof(uint32_t) + header.stringBytes;
+    if (tablesSize > size) {
+        std::cout << "ERROR::MESH_IMPORTER:: Truncated cache " << cachePath << std::endl;
+        return false;
+    }
+
+    const uint8_t* at = data + sizeof(header);
+    std::vector<MeshCachePart> parts(header.partCount);
+    std::memcpy(parts.data(), at, parts.size() * sizeof(MeshCachePart));
+    at += parts.size() * sizeof(MeshCachePart);
+    std::vector<MeshCacheMaterial> materials(header.materialCount);
+    std::memcpy(materials.data(), at, materials.size() * sizeof(MeshCacheMaterial));
+    at += materials.size() * sizeof(MeshCacheMaterial);
+    std::vector<uint32_t> dependencies(header.dependencyCount);
+    std::memcpy(dependencies.data(), at, dependencies.size() * sizeof(uint32_t));
+    at += dependencies.size() * sizeof(uint32_t);
+    const char* strings = (const char*)at;
+
+    auto stringAt = [&](uint32_t offset) -> std::string {
+        if (offset == kNoString || offset >= header.stringBytes) return std::string();
+        const char* begin = strings + offset;
+        const char* end = (const char*)std::memchr(begin, '\0', header.stringBytes - offset);
+        return end ? std::string(begin, end) : std::string();
+    };
+
+    for (uint32_t dependency : dependencies)
+        if (!isCookedUpToDate(stringAt(dependency), cachePath))
+            return false;
+
+    const VertexFormat& format = VertexFormat::getDefault();
+    for (const MeshCachePart& part : parts) {
+        size_t indexSize = (part.indexType == GL_UNSIGNED_SHORT) ? 2 : 4;
+        if (part.vertexOffset + (size_t)part.vertexCount * format.getStride() > size ||
+            part.positionOffset + (size_t)part.vertexCount * format.getPositionStride() > size ||
+            part.indexOffset + (size_t)part.indexCount * indexSize > size ||
+            part.meshletOffset + (size_t)part.meshletCount * sizeof(Meshlet) > size) {
+            std::cout << "ERROR::MESH_IMPORTER:: Truncated cache " << cachePath << std::endl;
+            return false;
+        }
+    }
+
+    for (const MeshCacheMaterial& source : materials) {
+        ImportedMaterial material;
+        material.name = stringAt(source.nameOffset);
+        material.albedoPath = stringAt(source.albedoOffset);
+        material.baseColor = glm::vec3(source.baseColor[0], source.baseColor[1], source.baseColor[2]);
+        material.doubleSided = (source.flags & kMaterialDoubleSided) != 0;
+        model.materials.push_back(material);
+    }
+
+    for (const MeshCachePart& source : parts) {
+        PackedMeshView view;
+        view.format = &format;
+        view.vertices = data + source.vertexOffset;
+        view.positions = data + source.positionOffset;
+        view.indices = data + source.indexOffset;
+        view.vertexCount = (int)source.vertexCount;
+        view.indexCount = (int)source.indexCount;
+        view.indexType = (GLenum)source.indexType;
+        for (int k = 0; k < 16; k++) view.dequantize[k / 4][k % 4] = source.dequantize[k];
+        view.meshlets = (const Meshlet*)(data + source.meshletOffset);
+        view.meshletCount = (int)source.meshletCount;
+
+        addPart(model, std::make_shared<Mesh>(view), source.material, source.lodLevel, source.lodError);
+    }
+
+    model.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    model.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    return true;
+}
+
+// ---------------------------------------------------------------- importer
+
+static size_t uploadedBytesOf(const ImportedModel& model) {
+    size_t bytes = 0;
+    for (const ImportedPart& part : model.parts) {
+        bytes += part.mesh->getByteSize();
+        for (const LodChain::Level& level : part.lods) bytes += level.mesh->getByteSize();
+    }
+    return bytes;
+}
+
+static int lodLevelsOf(const ImportedModel& model) {
+    int levels = 0;
+    for (const ImportedPart& part : model.parts) levels += (int)part.lods.size();
+    return levels;
+}
+
+// Full mesh of one builder followed by its simplified levels
+void MeshImporter::packPart(MeshBuilder& builder, int material, std::vector<PackedPart>& packed) const {
+    PackedPart base;
+    base.mesh = builder.buildPacked(VertexFormat::getDefault(), meshletTriangles);
+    base.material = material;
+    packed.push_back(std::move(base));
+    if (builder.getTriangleCount() < minLodTriangles) return;
+
+    const std::vector<float>& vertices = builder.getVertices();
+    const std::vector<unsigned int>& indices = builder.getIndices();
+    size_t previous = indices.size();
+    for (float ratio : lodRatios) {
+        size_t target = (size_t)(indices.size() / 3 * ratio) * 3;
+        std::vector<unsigned int> simplified;
+        float error = simplifyMesh(vertices, indices, target, INFINITY, simplified);
+        // Locked borders or seams can stop the collapse early; a level this close is not worth memory
+        if (simplified.empty() || simplified.size() > previous * 9 / 10) break;
+
+        MeshBuilder level;
+        level.addIndexed(vertices, simplified);
+        PackedPart part;
+        part.mesh = level.buildPacked(VertexFormat::getDefault(), meshletTriangles);
+        part.material = material;
+        part.lodLevel = packed.back().lodLevel + 1;
+        part.lodError = error;
+        packed.push_back(std::move(part));
+        previous = simplified.size();
+    }
+}
+
+uint32_t MeshImporter::getSettingsKey() const {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 16777619u;
+        }
+    };
+    for (float ratio : lodRatios) {
+        uint32_t bits;
+        std::memcpy(&bits, &ratio, sizeof(bits));
+        mix(bits);
+    }
+    mix((uint32_t)minLodTriangles);
+    mix((uint32_t)meshletTriangles);
+    return hash;
+}
+
+std::shared_ptr<const ImportedModel> MeshImporter::load(const std::string& path) {
+    PROFILE_FUNCTION();
+
+    auto found = entries.find(path);
+    if (found != entries.end()) {
+        if (auto existing = found->second.lock())
+            return existing;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&start]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto model = std::make_shared<ImportedModel>();
+    model->path = path;
+    std::string cachePath = cachePathFor(path);
+
+    if (readMeshCache(path, cachePath, getSettingsKey(), *model)) {
+        stats.cacheHits++;
+        stats.cacheLoadMs += elapsedMs();
+        stats.uploadedBytes += uploadedBytesOf(*model);
+        stats.lodLevels += lodLevelsOf(*model);
+        entries[path] = model;
+        return model;
+    }
+    // A rejected cache may have created parts before failing
+    model = std::make_shared<ImportedModel>();
+    model->path = path;
+
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        std::cout << "ERROR::MESH_IMPORTER:: File not found: " << path << std::endl;
+        return nullptr;
+    }
+
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    SourceModel source;
+    bool ok;
+    if (extension == ".obj") {
+        ok = importObj(path, source);
+    } else if (extension == ".gltf" || extension == ".glb") {
+        ok = importGltf(path, source);
+    } else {
+        std::cout << "ERROR::MESH_IMPORTER:: Unsupported format: " << path << std::endl;
+        return nullptr;
+    }
+    if (!ok) return nullptr;
+
+    std::vector<PackedPart> packed;
+    for (size_t i = 0; i < source.builders.size(); i++) {
+        if (source.builders[i].getTriangleCount() == 0) continue;
+        packPart(source.builders[i], (int)i, packed);
+    }
+    if (packed.empty()) {
+        std::cout << "ERROR::MESH_IMPORTER:: No triangles in " << path << std::endl;
+        return nullptr;
+    }
+
+    writeMeshCache(cachePath, source, packed, getSettingsKey());
+
+    model->materials = source.materials;
+    model->boundsMin = source.boundsMin;
+    model->boundsMax = source.boundsMax;
+    for (const PackedPart& part : packed)
+        addPart(*model, std::make_shared<Mesh>(part.mesh.view()), part.material, part.lodLevel, part.lodError);
+    stats.uploadedBytes += uploadedBytesOf(*model);
+    stats.lodLevels += lodLevelsOf(*model);
+
+    stats.imported++;
+    double ms = elapsedMs();
+    stats.importMs += ms;
+    std::cout << "Mesh importer: imported " << path << " (" << model->parts.size() << " parts, "
+              << model->materials.size() << " materials, " << lodLevelsOf(*model) << " LOD levels) | " << ms << " ms" << std::endl;
+
+    entries[path] = model;
+    return model;
+}
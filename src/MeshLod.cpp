@@ -0,0 +1,74 @@
+#include "MeshLod.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+// The chosen level's surface stays within this many pixels of the full mesh
+float LodChain::targetErrorPixels = 0.5f;
+float LodChain::hysteresis = 1.25f;
+int LodChain::shadowLodBias = 1;
+
+LodView LodView::perspective(const glm::vec3& eye, const glm::mat4& projection, int viewportHeight, int bias) {
+    LodView view;
+    view.eye = eye;
+    view.pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;
+    view.bias = bias;
+    return view;
+}
+
+LodView LodView::ortho(float pixelsPerUnit, int bias) {
+    LodView view;
+    view.pixelsPerUnit = pixelsPerUnit;
+    view.orthographic = true;
+    view.bias = bias;
+    return view;
+}
+
+std::shared_ptr<LodChain> LodChain::get(const std::string& key, int segments, int minSegments, float boundingRadius,
+                                        const std::function<std::shared_ptr<Mesh>(int segments)>& build)
+{
+    static std::map<std::string, std::weak_ptr<LodChain>> cache;
+
+    if (auto chain = cache[key].lock())
+        return chain;
+
+    const float kPi = 3.14159265359f;
+
+    auto chain = std::make_shared<LodChain>();
+    chain->boundingRadius = boundingRadius;
+    for (int count = segments; ; count /= 2) {
+        // Distance between a chord and its arc; the finest level is the reference
+        float error = (count == segments) ? 0.0f : boundingRadius * (1.0f - std::cos(kPi / count));
+        chain->levels.push_back({ build(count), error });
+        if (count / 2 < minSegments) break;
+    }
+
+    cache[key] = chain;
+    return chain;
+}
+
+int LodChain::select(const glm::vec3& center, float scale, const LodView& view, int current) const {
+    float pixelsPerUnit = view.pixelsPerUnit;
+    if (!view.orthographic)
+        pixelsPerUnit /= std::max(glm::length(center - view.eye), 0.01f);
+    float unitPixels = scale * pixelsPerUnit;
+
+    // Coarsest level whose error still projects under the target
+    auto levelFor = [&](float margin) {
+        int level = 0;
+        while (level + 1 < (int)levels.size() && levels[level + 1].error * unitPixels * margin <= targetErrorPixels)
+            level++;
+        return level;
+    };
+
+    int ideal = levelFor(1.0f);
+    // Measured as if the object were larger, so it must shrink a bit past the threshold
+    int withMargin = levelFor(hysteresis);
+
+    int level = (current < 0) ? ideal : current;
+    if (ideal < level)
+        level = ideal;
+    else if (withMargin > level)
+        level = withMargin;
+    return level;
+}
@@ -0,0 +1,306 @@
+#include "MeshSimplifier.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+static const int kFloatsPerVertex = 8;
+// Border planes are weighted this much more than the faces, so outlines hold
+static const double kBorderWeight = 10.0;
+// A collapse may not rotate a remaining triangle's normal by more than ~75 degrees
+static const float kMinNormalDot = 0.25f;
+
+namespace {
+
+// Sum of weighted squared plane distances, as a symmetric 4x4 matrix
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0;
+
+    void addPlane(const glm::vec3& normal, float d, double w) {
+        double x = normal.x, y = normal.y, z = normal.z;
+        a00 += w * x * x; a01 += w * x * y; a02 += w * x * z;
+        a11 += w * y * y; a12 += w * y * z; a22 += w * z * z;
+        b0 += w * x * d; b1 += w * y * d; b2 += w * z * d;
+        c += w * (double)d * d;
+        weight += w;
+    }
+
+    void add(const Quadric& other) {
+        a00 += other.a00; a01 += other.a01; a02 += other.a02;
+        a11 += other.a11; a12 += other.a12; a22 += other.a22;
+        b0 += other.b0; b1 += other.b1; b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+    }
+
+    // Weighted mean squared distance of p to the planes
+    double error(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double e = a00 * x * x + a11 * y * y + a22 * z * z
+                 + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                 + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return weight > 0.0 ? std::max(e, 0.0) / weight : 0.0;
+    }
+};
+
+struct Collapse {
+    unsigned int from;
+    unsigned int to;
+    double cost;
+};
+
+inline uint64_t edgeKey(unsigned int a, unsigned int b) {
+    if (a > b) std::swap(a, b);
+    return ((uint64_t)a << 32) | b;
+}
+
+}
+
+float simplifyMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices,
+                   size_t targetIndexCount, float maxError, std::vector<unsigned int>& result)
+{
+    size_t vertexCount = vertices.size() / kFloatsPerVertex;
+    result = indices;
+    if (indices.size() <= targetIndexCount || vertexCount == 0)
+        return 0.0f;
+
+    auto positionOf = [&](unsigned int v) {
+        return glm::vec3(vertices[v * kFloatsPerVertex], vertices[v * kFloatsPerVertex + 1], vertices[v * kFloatsPerVertex + 2]);
+    };
+
+    // Wedges (input vertices) sharing a position form one topological vertex
+    std::vector<unsigned int> positionId(vertexCount);
+    {
+        struct Key {
+            float p[3];
+            bool operator==(const Key& o) const { return std::memcmp(p, o.p, sizeof(p)) == 0; }
+        };
+        struct KeyHash {
+            size_t operator()(const Key& k) const {
+                uint32_t bits[3];
+                std::memcpy(bits, k.p, sizeof(bits));
+                return (size_t)(bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u);
+            }
+        };
+        std::unordered_map<Key, unsigned int, KeyHash> lookup;
+        lookup.reserve(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++) {
+            Key key;
+            std::memcpy(key.p, &vertices[v * kFloatsPerVertex], sizeof(key.p));
+            positionId[v] = lookup.emplace(key, (unsigned int)v).first->second;
+        }
+    }
+
+    // Edge use counts in position space: 1 = border, 2 = manifold, more = locked
+    std::unordered_map<uint64_t, int> edgeUses;
+    auto countEdges = [&](const std::vector<unsigned int>& list) {
+        edgeUses.clear();
+        for (size_t t = 0; t + 2 < list.size(); t += 3)
+            for (int k = 0; k < 3; k++)
+                edgeUses[edgeKey(positionId[list[t + k]], positionId[list[t + (k + 1) % 3]])]++;
+    };
+    countEdges(result);
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t t = 0; t + 2 < result.size(); t += 3) {
+        unsigned int p[3] = { positionId[result[t]], positionId[result[t + 1]], positionId[result[t + 2]] };
+        glm::vec3 a = positionOf(p[0]), b = positionOf(p[1]), c = positionOf(p[2]);
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float doubleArea = glm::length(normal);
+        if (doubleArea <= 0.0f) continue;
+        normal /= doubleArea;
+
+        for (int k = 0; k < 3; k++)
+            quadrics[p[k]].addPlane(normal, -glm::dot(normal, a), 0.5 * doubleArea);
+
+        // Planes through border edges, perpendicular to the face
+        for (int k = 0; k < 3; k++) {
+            unsigned int e0 = p[k], e1 = p[(k + 1) % 3];
+            if (edgeUses[edgeKey(e0, e1)] != 1) continue;
+            glm::vec3 edge = positionOf(e1) - positionOf(e0);
+            float length = glm::length(edge);
+            if (length <= 0.0f) continue;
+            glm::vec3 borderNormal = glm::normalize(glm::cross(edge, normal));
+            double w = kBorderWeight * length * length;
+            quadrics[e0].addPlane(borderNormal, -glm::dot(borderNormal, positionOf(e0)), w);
+            quadrics[e1].addPlane(borderNormal, -glm::dot(borderNormal, positionOf(e0)), w);
+        }
+    }
+
+    std::vector<unsigned int> wedgeRemap(vertexCount);
+    std::vector<unsigned int> triangleStart(vertexCount + 1), triangleList;
+    std::vector<unsigned char> isBorder(vertexCount), isLocked(vertexCount), touched(vertexCount);
+    std::vector<unsigned int> mappedTo(vertexCount, ~0u);
+    std::vector<Collapse> candidates;
+    std::vector<unsigned int> neighbors, wedgesUsed;
+    double worstError = 0.0;
+
+    while (result.size() > targetIndexCount) {
+        size_t triangleCount = result.size() / 3;
+
+        // Triangles around each position
+        std::fill(triangleStart.begin(), triangleStart.end(), 0);
+        for (unsigned int index : result) triangleStart[positionId[index] + 1]++;
+        for (size_t v = 0; v < vertexCount; v++) triangleStart[v + 1] += triangleStart[v];
+        triangleList.resize(result.size());
+        {
+            std::vector<unsigned int> fill(triangleStart.begin(), triangleStart.end() - 1);
+            for (size_t i = 0; i < result.size(); i++)
+                triangleList[fill[positionId[result[i]]]++] = (unsigned int)(i / 3);
+        }
+
+        std::fill(isBorder.begin(), isBorder.end(), 0);
+        std::fill(isLocked.begin(), isLocked.end(), 0);
+        for (const auto& [key, uses] : edgeUses) {
+            unsigned int a = (unsigned int)(key >> 32), b = (unsigned int)key;
+            if (uses == 1) isBorder[a] = isBorder[b] = 1;
+            if (uses > 2) isLocked[a] = isLocked[b] = 1;
+        }
+
+        // Cheapest allowed direction of every edge
+        candidates.clear();
+        for (const auto& [key, uses] : edgeUses) {
+            if (uses > 2) continue;
+            unsigned int a = (unsigned int)(key >> 32), b = (unsigned int)key;
+            Quadric combined = quadrics[a];
+            combined.add(quadrics[b]);
+
+            Collapse best{ 0, 0, -1.0 };
+            for (int direction = 0; direction < 2; direction++) {
+                unsigned int from = direction ? b : a, to = direction ? a : b;
+                if (isLocked[from]) continue;
+                // Border vertices only slide along their border
+                if (isBorder[from] && (uses != 1 || !isBorder[to])) continue;
+                double cost = combined.error(positionOf(to));
+                if (best.cost < 0.0 || cost < best.cost) best = { from, to, cost };
+            }
+            if (best.cost >= 0.0 && best.cost <= (double)maxError * maxError)
+                candidates.push_back(best);
+        }
+        if (candidates.empty()) break;
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        for (size_t v = 0; v < vertexCount; v++) wedgeRemap[v] = (unsigned int)v;
+        std::fill(touched.begin(), touched.end(), 0);
+
+        size_t trianglesLeft = triangleCount;
+        size_t targetTriangles = targetIndexCount / 3;
+        int collapses = 0;
+
+        for (const Collapse& collapse : candidates) {
+            if (trianglesLeft <= targetTriangles) break;
+            unsigned int from = collapse.from, to = collapse.to;
+            if (touched[from] || touched[to]) continue;
+
+            // Link condition: the endpoints may only share the vertices opposite the edge
+            neighbors.clear();
+            int sharedTriangles = 0;
+            for (unsigned int i = triangleStart[from]; i < triangleStart[from + 1]; i++) {
+                const unsigned int* tri = &result[triangleList[i] * 3];
+                bool hasTo = false;
+                for (int k = 0; k < 3; k++) hasTo |= positionId[tri[k]] == to;
+                if (hasTo) sharedTriangles++;
+                for (int k = 0; k < 3; k++) {
+                    unsigned int p = positionId[tri[k]];
+                    if (p != from && p != to) neighbors.push_back(p);
+                }
+            }
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+            int common = 0;
+            for (unsigned int i = triangleStart[to]; i < triangleStart[to + 1] && common <= sharedTriangles; i++) {
+                const unsigned int* tri = &result[triangleList[i] * 3];
+                for (int k = 0; k < 3; k++) {
+                    unsigned int p = positionId[tri[k]];
+                    if (p != from && p != to && std::binary_search(neighbors.begin(), neighbors.end(), p)) {
+                        common++;
+                        // Count each shared neighbour once
+                        neighbors.erase(std::lower_bound(neighbors.begin(), neighbors.end(), p));
+                    }
+                }
+            }
+            if (common > sharedTriangles) continue;
+
+            // Every wedge of `from` needs exactly one wedge of `to` to become,
+            // found through the triangles that collapse
+            bool valid = true;
+            wedgesUsed.clear();
+            for (unsigned int i = triangleStart[from]; i < triangleStart[from + 1] && valid; i++) {
+                const unsigned int* tri = &result[triangleList[i] * 3];
+                unsigned int fromWedge = ~0u, toWedge = ~0u;
+                for (int k = 0; k < 3; k++) {
+                    if (positionId[tri[k]] == from) fromWedge = tri[k];
+                    if (positionId[tri[k]] == to) toWedge = tri[k];
+                }
+                if (toWedge == ~0u) continue;
+                if (mappedTo[fromWedge] == ~0u) {
+                    mappedTo[fromWedge] = toWedge;
+                    wedgesUsed.push_back(fromWedge);
+                } else if (mappedTo[fromWedge] != toWedge) {
+                    valid = false;
+                }
+            }
+
+            // The remaining triangles must keep their orientation
+            glm::vec3 target = positionOf(to);
+            for (unsigned int i = triangleStart[from]; i < triangleStart[from + 1] && valid; i++) {
+                const unsigned int* tri = &result[triangleList[i] * 3];
+                int fromCorner = -1;
+                bool hasTo = false;
+                for (int k = 0; k < 3; k++) {
+                    if (positionId[tri[k]] == from) fromCorner = k;
+                    hasTo |= positionId[tri[k]] == to;
+                }
+                if (hasTo) continue;
+                if (mappedTo[tri[fromCorner]] == ~0u) { valid = false; break; }
+
+                glm::vec3 corners[3] = { positionOf(tri[0]), positionOf(tri[1]), positionOf(tri[2]) };
+                glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                corners[fromCorner] = target;
+                glm::vec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                float lengths = glm::length(before) * glm::length(after);
+                if (lengths <= 0.0f || glm::dot(before, after) < kMinNormalDot * lengths)
+                    valid = false;
+            }
+
+            if (valid) {
+                for (unsigned int wedge : wedgesUsed) wedgeRemap[wedge] = mappedTo[wedge];
+                quadrics[to].add(quadrics[from]);
+                worstError = std::max(worstError, collapse.cost);
+                trianglesLeft -= sharedTriangles;
+                collapses++;
+
+                // The one-ring of `from` changed shape; leave it alone until the next pass
+                touched[from] = touched[to] = 1;
+                for (unsigned int i = triangleStart[from]; i < triangleStart[from + 1]; i++)
+                    for (int k = 0; k < 3; k++)
+                        touched[positionId[result[triangleList[i] * 3 + k]]] = 1;
+            }
+            for (unsigned int wedge : wedgesUsed) mappedTo[wedge] = ~0u;
+        }
+
+        if (collapses == 0) break;
+
+        // Apply the pass: redirect wedges and drop triangles that lost an edge
+        size_t write = 0;
+        for (size_t t = 0; t + 2 < result.size(); t += 3) {
+            unsigned int a = wedgeRemap[result[t]], b = wedgeRemap[result[t + 1]], c = wedgeRemap[result[t + 2]];
+            unsigned int pa = positionId[a], pb = positionId[b], pc = positionId[c];
+            if (pa == pb || pb == pc || pa == pc) continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+        countEdges(result);
+    }
+
+    return (float)std::sqrt(worstError);
+}
@@ -0,0 +1,173 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+static const int kFloatsPerVertex = 8;
+
+static glm::vec3 positionAt(const std::vector<float>& vertices, unsigned int v) {
+    const float* p = &vertices[(size_t)v * kFloatsPerVertex];
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+// Bounding sphere around the box of the cluster, and the cone of its face normals
+static void computeBounds(const std::vector<float>& vertices, const unsigned int* indices,
+                          const std::vector<glm::vec3>& normals, const std::vector<unsigned int>& triangles,
+                          Meshlet& meshlet)
+{
+    glm::vec3 low(INFINITY), high(-INFINITY);
+    for (size_t i = 0; i < meshlet.indexCount; i++) {
+        glm::vec3 p = positionAt(vertices, indices[i]);
+        low = glm::min(low, p);
+        high = glm::max(high, p);
+    }
+    meshlet.center = 0.5f * (low + high);
+    float radiusSquared = 0.0f;
+    for (size_t i = 0; i < meshlet.indexCount; i++) {
+        glm::vec3 d = positionAt(vertices, indices[i]) - meshlet.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(d, d));
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+
+    glm::vec3 sum(0.0f);
+    for (unsigned int t : triangles) sum += normals[t];
+    float length = glm::length(sum);
+    meshlet.coneCutoff = 2.0f;
+    if (length <= 0.0f) return;
+    meshlet.coneAxis = sum / length;
+
+    // Normals within angle a of the axis: all face away once the view
+    // direction is within 90 - a degrees of it, i.e. cos(90 - a) = sin(a)
+    float minDot = 1.0f;
+    for (unsigned int t : triangles)
+        if (normals[t] != glm::vec3(0.0f))
+            minDot = std::min(minDot, glm::dot(normals[t], meshlet.coneAxis));
+    if (minDot > 0.0f)
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+std::vector<Meshlet> buildMeshlets(const std::vector<float>& vertices, std::vector<unsigned int>& indices,
+                                   int maxTriangles)
+{
+    std::vector<Meshlet> meshlets;
+    size_t vertexCount = vertices.size() / kFloatsPerVertex;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return meshlets;
+
+    // Seams split vertices; adjacency goes by shared positions instead
+    std::vector<unsigned int> positionId(vertexCount);
+    {
+        struct Key {
+            float p[3];
+            bool operator==(const Key& o) const { return std::memcmp(p, o.p, sizeof(p)) == 0; }
+        };
+        struct KeyHash {
+            size_t operator()(const Key& k) const {
+                uint32_t bits[3];
+                std::memcpy(bits, k.p, sizeof(bits));
+                return (size_t)(bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u);
+            }
+        };
+        std::unordered_map<Key, unsigned int, KeyHash> lookup;
+        lookup.reserve(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++) {
+            Key key;
+            std::memcpy(key.p, &vertices[v * kFloatsPerVertex], sizeof(key.p));
+            positionId[v] = lookup.emplace(key, (unsigned int)lookup.size()).first->second;
+        }
+    }
+
+    // Triangles around each position, as offsets into one array
+    std::vector<unsigned int> firstTriangle(vertexCount + 1, 0);
+    for (unsigned int index : indices) firstTriangle[positionId[index] + 1]++;
+    for (size_t p = 0; p < vertexCount; p++) firstTriangle[p + 1] += firstTriangle[p];
+    std::vector<unsigned int> adjacent(indices.size());
+    {
+        std::vector<unsigned int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjacent[fill[positionId[indices[i]]]++] = (unsigned int)(i / 3);
+    }
+
+    std::vector<glm::vec3> normals(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        glm::vec3 a = positionAt(vertices, indices[t * 3]);
+        glm::vec3 b = positionAt(vertices, indices[t * 3 + 1]);
+        glm::vec3 c = positionAt(vertices, indices[t * 3 + 2]);
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        normals[t] = (length > 0.0f) ? n / length : glm::vec3(0.0f);
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> inCluster(vertexCount, ~0u);     // cluster that last took this position
+    std::vector<unsigned int> clustered;
+    clustered.reserve(indices.size());
+    std::vector<unsigned int> triangles, candidates;
+    size_t nextSeed = 0;
+
+    while (clustered.size() < indices.size()) {
+        unsigned int cluster = (unsigned int)meshlets.size();
+        triangles.clear();
+        candidates.clear();
+        glm::vec3 normalSum(0.0f);
+
+        auto take = [&](unsigned int t) {
+            emitted[t] = true;
+            triangles.push_back(t);
+            normalSum += normals[t];
+            for (int k = 0; k < 3; k++) {
+                unsigned int p = positionId[indices[t * 3 + k]];
+                if (inCluster[p] == cluster) continue;
+                inCluster[p] = cluster;
+                for (unsigned int i = firstTriangle[p]; i < firstTriangle[p + 1]; i++)
+                    if (!emitted[adjacent[i]]) candidates.push_back(adjacent[i]);
+            }
+        };
+
+        while ((int)triangles.size() < maxTriangles) {
+            // Fewest new vertices first, then the normal closest to the cluster's
+            float length = glm::length(normalSum);
+            glm::vec3 axis = (length > 0.0f) ? normalSum / length : glm::vec3(0.0f);
+            int best = -1;
+            float bestScore = -INFINITY;
+            for (size_t i = 0; i < candidates.size(); ) {
+                unsigned int t = candidates[i];
+                if (emitted[t]) {
+                    candidates[i] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+                int shared = 0;
+                for (int k = 0; k < 3; k++)
+                    shared += (inCluster[positionId[indices[t * 3 + k]]] == cluster) ? 1 : 0;
+                float score = (float)shared + glm::dot(normals[t], axis);
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = (int)t;
+                }
+                i++;
+            }
+
+            if (best < 0) {
+                // Island finished: continue with the next triangle in input order
+                while (nextSeed < triangleCount && emitted[nextSeed]) nextSeed++;
+                if (nextSeed == triangleCount) break;
+                best = (int)nextSeed;
+            }
+            take((unsigned int)best);
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+        Meshlet meshlet;
+        meshlet.firstIndex = (uint32_t)clustered.size();
+        meshlet.indexCount = (uint32_t)triangles.size() * 3;
+        for (unsigned int t : triangles)
+            for (int k = 0; k < 3; k++) clustered.push_back(indices[t * 3 + k]);
+        computeBounds(vertices, &clustered[meshlet.firstIndex], normals, triangles, meshlet);
+        meshlets.push_back(meshlet);
+    }
+
+    indices.swap(clustered);
+    return meshlets;
+}
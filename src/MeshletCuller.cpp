@@ -0,0 +1,194 @@
+#include "MeshletCuller.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+MeshletCuller* GMeshletCuller = nullptr;
+bool MeshletCuller::enabled = true;
+
+// Clusters per worker job; small meshes stay on the calling thread
+static const size_t kClustersPerBatch = 256;
+
+static int cullThreadCount() {
+    int cores = (int)std::thread::hardware_concurrency();
+    return std::clamp(cores - 1, 1, 4);
+}
+
+struct MeshletCuller::Batch {
+    Shape* shape = nullptr;
+    const Mesh* mesh = nullptr;
+    glm::mat4 transform = glm::mat4(1.0f);
+    float scale = 1.0f;             // largest axis, for the sphere radius
+    bool cones = false;
+    size_t begin = 0, end = 0;
+
+    // Visible index ranges, adjacent clusters merged
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    int clustersVisible = 0;
+    long long trianglesTested = 0;
+    long long trianglesVisible = 0;
+};
+
+CullView CullView::fromMatrix(const glm::mat4& m, const glm::vec3& eye, bool backfaces) {
+    // Gribb-Hartmann: each plane is the last row plus or minus another row
+    auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+    CullView view;
+    view.planes[0] = row(3) + row(0);
+    view.planes[1] = row(3) - row(0);
+    view.planes[2] = row(3) + row(1);
+    view.planes[3] = row(3) - row(1);
+    view.planes[4] = row(3) + row(2);
+    view.planes[5] = row(3) - row(2);
+    for (glm::vec4& plane : view.planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) plane /= length;
+    }
+    view.eye = eye;
+    view.backfaces = backfaces;
+    return view;
+}
+
+bool CullView::intersectsSphere(const glm::vec3& center, float radius) const {
+    for (const glm::vec4& plane : planes)
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+            return false;
+    return true;
+}
+
+bool CullView::facesAway(const glm::vec3& center, float radius, const glm::vec3& coneAxis, float coneCutoff) const {
+    if (!backfaces || coneCutoff > 1.0f) return false;
+    glm::vec3 toCenter = center - eye;
+    return glm::dot(toCenter, coneAxis) >= coneCutoff * glm::length(toCenter) + radius;
+}
+
+MeshletCuller::MeshletCuller()
+    : pool(std::make_unique<ThreadPool>(cullThreadCount(), "Cluster cull"))
+{
+    glGenBuffers(1, &indexBuffer);
+}
+
+MeshletCuller::~MeshletCuller() {
+    pool.reset();
+    glDeleteBuffers(1, &indexBuffer);
+}
+
+void MeshletCuller::cullBatch(Batch& batch, const CullView& view) {
+    const std::vector<Meshlet>& meshlets = batch.mesh->getMeshlets();
+    glm::mat3 linear(batch.transform);
+
+    for (size_t i = batch.begin; i < batch.end; i++) {
+        const Meshlet& meshlet = meshlets[i];
+        batch.trianglesTested += meshlet.indexCount / 3;
+
+        glm::vec3 center = glm::vec3(batch.transform * glm::vec4(meshlet.center, 1.0f));
+        float radius = meshlet.radius * batch.scale;
+
+        if (!view.intersectsSphere(center, radius))
+            continue;
+        if (batch.cones && view.facesAway(center, radius, linear * meshlet.coneAxis / batch.scale, meshlet.coneCutoff))
+            continue;
+
+        batch.clustersVisible++;
+        batch.trianglesVisible += meshlet.indexCount / 3;
+        if (!batch.ranges.empty() && batch.ranges.back().first + batch.ranges.back().second == meshlet.firstIndex)
+            batch.ranges.back().second += meshlet.indexCount;
+        else
+            batch.ranges.push_back({ meshlet.firstIndex, meshlet.indexCount });
+    }
+}
+
+void MeshletCuller::reset(const std::vector<std::shared_ptr<Shape>>& shapes) {
+    for (const auto& shape : shapes)
+        shape->clearVisibleIndices();
+}
+
+void MeshletCuller::cull(const std::vector<std::shared_ptr<Shape>>& shapes, const CullView& view) {
+    PROFILE_FUNCTION();
+    auto start = std::chrono::steady_clock::now();
+
+    reset(shapes);
+    if (!enabled) return;
+
+    std::vector<Batch> batches;
+    for (const auto& shape : shapes) {
+        const Mesh* mesh = shape->getCurrentMesh();
+        if (!mesh || mesh->getMeshlets().empty()) continue;
+
+        Batch batch;
+        batch.shape = shape.get();
+        batch.mesh = mesh;
+        batch.transform = shape->getMeshMatrix();
+        glm::mat3 linear(batch.transform);
+        batch.scale = std::max(glm::length(linear[0]), std::max(glm::length(linear[1]), glm::length(linear[2])));
+        if (batch.scale <= 0.0f) continue;
+        glm::vec3 scale = shape->scale;
+        // Cone bounds survive rotation and uniform scale only; mirrored or stretched shapes get frustum tests
+        batch.cones = !shape->isDoubleSided() &&
+                      scale.x > 0.0f && scale.x == scale.y && scale.y == scale.z;
+
+        size_t count = mesh->getMeshlets().size();
+        for (size_t begin = 0; begin < count; begin += kClustersPerBatch) {
+            batch.begin = begin;
+            batch.end = std::min(count, begin + kClustersPerBatch);
+            batches.push_back(batch);
+        }
+    }
+    if (batches.empty()) return;
+
+    // The calling thread takes the first batch, workers the rest
+    {
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t remaining = batches.size() - 1;
+        for (size_t i = 1; i < batches.size(); i++) {
+            pool->submit([&, i] {
+                cullBatch(batches[i], view);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--remaining == 0) done.notify_one();
+            });
+        }
+        cullBatch(batches[0], view);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&remaining] { return remaining == 0; });
+    }
+
+    // Batches of one shape are consecutive; pack each shape's survivors into one range
+    staging.clear();
+    for (size_t i = 0; i < batches.size(); ) {
+        const Mesh* mesh = batches[i].mesh;
+        size_t indexSize = mesh->getIndexSize();
+        size_t offset = (staging.size() + 3) & ~(size_t)3;
+        staging.resize(offset);
+
+        size_t next = i;
+        for (; next < batches.size() && batches[next].shape == batches[i].shape; next++) {
+            const Batch& batch = batches[next];
+            for (const auto& range : batch.ranges) {
+                size_t at = staging.size();
+                staging.resize(at + range.second * indexSize);
+                std::memcpy(&staging[at], mesh->getIndexData() + range.first * indexSize, range.second * indexSize);
+            }
+            stats.clustersTested += (long long)(batch.end - batch.begin);
+            stats.clustersVisible += batch.clustersVisible;
+            stats.trianglesTested += batch.trianglesTested;
+            stats.trianglesVisible += batch.trianglesVisible;
+        }
+        batches[i].shape->setVisibleIndices(mesh, indexBuffer, offset, (int)((staging.size() - offset) / indexSize));
+        i = next;
+    }
+
+    // Not GL_ELEMENT_ARRAY_BUFFER: that binding belongs to whichever VAO is bound
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, staging.size(), staging.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    stats.passes++;
+    stats.cullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
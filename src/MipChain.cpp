@@ -0,0 +1,100 @@
+#include "MipChain.h"
+#include <algorithm>
+#include <cmath>
+
+static float lanczos2(float x) {
+    x = std::fabs(x);
+    if (x < 1e-5f) return 1.0f;
+    if (x >= 2.0f) return 0.0f;
+
+    const float pi = 3.14159265358979f;
+    float px = pi * x;
+    return 2.0f * std::sin(px) * std::sin(px / 2.0f) / (px * px);
+}
+
+struct FilterTap {
+    int source;
+    float weight;
+};
+
+// Taps for every destination sample along one axis
+static std::vector<std::vector<FilterTap>> buildTaps(int sourceSize, int destSize, bool wrap) {
+    std::vector<std::vector<FilterTap>> taps(destSize);
+    float scale = (float)sourceSize / destSize;
+    float support = 2.0f * scale;
+
+    for (int x = 0; x < destSize; x++) {
+        float center = (x + 0.5f) * scale;
+        int first = (int)std::floor(center - support);
+        int last  = (int)std::ceil(center + support);
+
+        float total = 0.0f;
+        for (int i = first; i <= last; i++) {
+            float weight = lanczos2((i + 0.5f - center) / scale);
+            if (weight == 0.0f) continue;
+
+            int source = wrap ? ((i % sourceSize) + sourceSize) % sourceSize
+                              : std::clamp(i, 0, sourceSize - 1);
+            taps[x].push_back({ source, weight });
+            total += weight;
+        }
+        for (auto& tap : taps[x])
+            tap.weight /= total;
+    }
+    return taps;
+}
+
+FloatImage downsampleImage(const FloatImage& source, bool wrap) {
+    int width  = std::max(1, source.width / 2);
+    int height = std::max(1, source.height / 2);
+    int channels = source.channels;
+
+    auto tapsX = buildTaps(source.width, width, wrap);
+    auto tapsY = buildTaps(source.height, height, wrap);
+
+    // Horizontal pass into a width x source.height image, then vertical
+    FloatImage horizontal;
+    horizontal.width = width;
+    horizontal.height = source.height;
+    horizontal.channels = channels;
+    horizontal.pixels.assign((size_t)width * source.height * channels, 0.0f);
+
+    for (int y = 0; y < source.height; y++) {
+        for (int x = 0; x < width; x++) {
+            float* dst = horizontal.at(x, y);
+            for (const FilterTap& tap : tapsX[x]) {
+                const float* src = source.at(tap.source, y);
+                for (int c = 0; c < channels; c++)
+                    dst[c] += src[c] * tap.weight;
+            }
+        }
+    }
+
+    FloatImage result;
+    result.width = width;
+    result.height = height;
+    result.channels = channels;
+    result.pixels.assign((size_t)width * height * channels, 0.0f);
+
+    for (int y = 0; y < height; y++) {
+        for (const FilterTap& tap : tapsY[y]) {
+            for (int x = 0; x < width; x++) {
+                const float* src = horizontal.at(x, tap.source);
+                float* dst = result.at(x, y);
+                for (int c = 0; c < channels; c++)
+                    dst[c] += src[c] * tap.weight;
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<FloatImage> buildMipChain(FloatImage base, bool wrap) {
+    std::vector<FloatImage> chain;
+    chain.push_back(std::move(base));
+
+    while (chain.back().width > 1 || chain.back().height > 1)
+        chain.push_back(downsampleImage(chain.back(), wrap));
+
+    return chain;
+}
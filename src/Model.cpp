@@ -0,0 +1,51 @@
+#include "Model.h"
+#include "TextureManager.h"
+#include <algorithm>
+
+Model::Model(std::shared_ptr<const ImportedModel> source, size_t partIndex)
+    : source(source)
+{
+    const ImportedPart& part = source->parts[partIndex];
+    mesh = part.mesh;
+
+    glm::vec3 extent = source->boundsMax - source->boundsMin;
+    float largest = std::max(extent.x, std::max(extent.y, extent.z));
+    float fit = (largest > 0.0f) ? 1.0f / largest : 1.0f;
+    glm::vec3 center = 0.5f * (source->boundsMin + source->boundsMax);
+    meshTransform = glm::translate(glm::scale(glm::mat4(1.0f), glm::vec3(fit)), -center);
+
+    // Simplified levels are measured in model units; the chain wants the fitted space
+    if (!part.lods.empty()) {
+        lods = std::make_shared<LodChain>();
+        lods->boundingRadius = 0.5f * glm::length(extent) * fit;
+        lods->levels.push_back({ part.mesh, 0.0f });
+        for (const LodChain::Level& level : part.lods)
+            lods->levels.push_back({ level.mesh, level.error * fit });
+    }
+
+    if (part.material >= 0 && part.material < (int)source->materials.size()) {
+        const ImportedMaterial& material = source->materials[part.material];
+        color = material.baseColor;
+        doubleSided = material.doubleSided;
+        if (!material.albedoPath.empty())
+            addTexture(GTextureManager->load(material.albedoPath, "texture_albedo"));
+    }
+}
+
+void Model::draw(Shader& shader) {
+    applyTransform(shader);
+
+    bindTextures(shader);
+
+    drawMesh();
+}
+
+std::vector<std::shared_ptr<Model>> Model::load(const std::string& path) {
+    std::vector<std::shared_ptr<Model>> parts;
+    std::shared_ptr<const ImportedModel> imported = GMeshImporter->load(path);
+    if (!imported) return parts;
+
+    for (size_t i = 0; i < imported->parts.size(); i++)
+        parts.push_back(std::make_shared<Model>(imported, i));
+    return parts;
+}
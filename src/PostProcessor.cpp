@@ -1,61 +1,76 @@
 #include "PostProcessor.h"
+#include "RenderTargetPool.h"
+#include "ShaderLibrary.h"
+#include "GLState.h"
 #include <iostream>
 
+extern unsigned int defaultFramebuffer;
+
 PostProcessor::PostProcessor(int width, int height) {
-    shader = std::make_unique<Shader>("src/motion_blur.vert", "src/motion_blur.frag");
+    shader = GShaderLibrary->load("src/motion_blur.vert", "src/motion_blur.frag");
     firstFrame = true;
     prevViewProjection = glm::mat4(1.0f);
 
     glGenFramebuffers(1, &FBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-
-    glGenTextures(1, &colorTexture);
-    glBindTexture(GL_TEXTURE_2D, colorTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
-
-    glGenTextures(1, &depthTexture);
-    glBindTexture(GL_TEXTURE_2D, depthTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::POSTPROCESSOR:: Framebuffer is not complete!" << std::endl;
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    acquireTargets(width, height);
     initRenderData();
 }
 
 PostProcessor::~PostProcessor() {
+    releaseTargets();
+    GGLState->forgetFramebuffer(FBO);
+    GGLState->forgetVertexArray(VAO);
     glDeleteFramebuffers(1, &FBO);
-    glDeleteTextures(1, &colorTexture);
-    glDeleteTextures(1, &depthTexture);
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
 }
 
 void PostProcessor::resize(int width, int height) {
-    glBindTexture(GL_TEXTURE_2D, colorTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    if (width <= 0 || height <= 0)
+        return;
+    if (width == this->width && height == this->height)
+        return;
+
+    releaseTargets();
+    acquireTargets(width, height);
+}
+
+void PostProcessor::acquireTargets(int width, int height) {
+    this->width  = width;
+    this->height = height;
+
+    colorTexture = GRenderTargetPool->acquire({
+        width, height, GL_RGB, GL_RGB, GL_UNSIGNED_BYTE, RenderTargetUsage::Color
+    });
+    depthTexture = GRenderTargetPool->acquire({
+        width, height, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT, RenderTargetUsage::Depth
+    });
+
+    GGLState->bindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::POSTPROCESSOR:: Framebuffer is not complete!" << std::endl;
+
+    GGLState->bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
 
-    glBindTexture(GL_TEXTURE_2D, depthTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+void PostProcessor::releaseTargets() {
+    GRenderTargetPool->release(colorTexture);
+    GRenderTargetPool->release(depthTexture);
 }
 
 void PostProcessor::beginRender() {
-    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    GGLState->bindFramebuffer(GL_FRAMEBUFFER, FBO);
+    GGLState->setEnabled(GL_DEPTH_TEST, true);
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
 }
 
 void PostProcessor::endRender() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glDisable(GL_DEPTH_TEST);
+    GGLState->bindFramebuffer(GL_FRAMEBUFFER, defaultFramebuffer);
+    GGLState->setEnabled(GL_DEPTH_TEST, false);
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -75,17 +90,14 @@ void PostProcessor::draw(const glm::mat4& view, const glm::mat4& projection, flo
     shader->setBool("useMotionBlur", enabled);
     shader->setFloat("fps", currentFPS);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    GGLState->bindTexture(0, GL_TEXTURE_2D, colorTexture);
     shader->setInt("screenTexture", 0);
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    GGLState->bindTexture(1, GL_TEXTURE_2D, depthTexture);
     shader->setInt("depthTexture", 1);
 
-    glBindVertexArray(VAO);
+    GGLState->bindVertexArray(VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
 
     prevViewProjection = currentViewProjection;
 }
@@ -103,7 +115,7 @@ void PostProcessor::initRenderData() {
 
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
+    GGLState->bindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
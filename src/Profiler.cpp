@@ -0,0 +1,109 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+thread_local Profiler::ThreadBuffer* Profiler::tlsBuffer = nullptr;
+
+static std::mutex g_registryMutex;
+static std::vector<std::unique_ptr<Profiler::ThreadBuffer>> g_threadBuffers;
+
+// Reference point for converting raw ticks to microseconds
+static const uint64_t g_startTicks = Profiler::now();
+static const auto     g_startClock = std::chrono::steady_clock::now();
+
+Profiler::ThreadBuffer* Profiler::registerThread() {
+    // Only hit once per thread; zones themselves never take the lock
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_threadBuffers.push_back(std::make_unique<ThreadBuffer>());
+
+    ThreadBuffer* buffer = g_threadBuffers.back().get();
+    buffer->threadIndex = (uint32_t)g_threadBuffers.size();
+    buffer->threadName = "Thread " + std::to_string(buffer->threadIndex);
+    return buffer;
+}
+
+void Profiler::init() {
+    setThreadName("Main");
+}
+
+void Profiler::setThreadName(const char* name) {
+    ThreadBuffer* buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    buffer->threadName = name;
+}
+
+static double ticksPerMicrosecond() {
+#ifdef PROFILER_USE_TSC
+    // Calibrate the TSC against the steady clock over the whole run
+    uint64_t ticks = Profiler::now() - g_startTicks;
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - g_startClock).count();
+    if (micros < 1000.0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ticks = Profiler::now() - g_startTicks;
+        micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - g_startClock).count();
+    }
+    return ticks / micros;
+#else
+    return std::chrono::steady_clock::period::den / (1.0e6 * std::chrono::steady_clock::period::num);
+#endif
+}
+
+static void writeJsonString(std::ofstream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+bool Profiler::dumpChromeTrace(const char* path) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "ERROR::PROFILER:: Cannot open trace file: " << path << "\n";
+        return false;
+    }
+
+    double tickScale = 1.0 / ticksPerMicrosecond();
+    size_t eventCount = 0;
+
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (const auto& buffer : g_threadBuffers) {
+        out << (first ? "" : ",\n")
+            << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->threadIndex
+            << ",\"args\":{\"name\":";
+        writeJsonString(out, buffer->threadName);
+        out << "}}";
+        first = false;
+
+        // The owning thread may keep writing; the oldest entries can be torn, which is fine for a trace
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > ThreadBuffer::kCapacity ? head - ThreadBuffer::kCapacity : 0;
+
+        for (uint64_t i = begin; i < head; i++) {
+            const Event& e = buffer->events[i & (ThreadBuffer::kCapacity - 1)];
+            if (e.end < e.start || e.start < g_startTicks) continue;
+
+            out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadIndex
+                << ",\"name\":";
+            writeJsonString(out, e.name);
+            out << ",\"ts\":" << (e.start - g_startTicks) * tickScale
+                << ",\"dur\":" << (e.end - e.start) * tickScale << "}";
+            eventCount++;
+        }
+    }
+
+    out << "\n]}\n";
+    std::cout << "Profiler: wrote " << eventCount << " zones to " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,74 @@
+#include "RenderTargetPool.h"
+#include "GLState.h"
+#include <iostream>
+
+RenderTargetPool* GRenderTargetPool = nullptr;
+
+// Free textures older than this are given back to the driver
+static const long long kMaxIdleFrames = 120;
+
+RenderTargetPool::~RenderTargetPool() {
+    for (auto& entry : entries) {
+        GGLState->forgetTexture(entry.texture);
+        glDeleteTextures(1, &entry.texture);
+    }
+}
+
+unsigned int RenderTargetPool::acquire(const RenderTargetDesc& desc) {
+    for (auto& entry : entries) {
+        if (!entry.inUse && entry.desc == desc) {
+            entry.inUse = true;
+            entry.lastUsedFrame = frameIndex;
+            return entry.texture;
+        }
+    }
+
+    unsigned int texture = allocate(desc);
+    entries.push_back({ desc, texture, true, frameIndex });
+    return texture;
+}
+
+void RenderTargetPool::release(unsigned int texture) {
+    for (auto& entry : entries) {
+        if (entry.texture == texture) {
+            entry.inUse = false;
+            entry.lastUsedFrame = frameIndex;
+            return;
+        }
+    }
+}
+
+void RenderTargetPool::beginFrame() {
+    frameIndex++;
+    frameAllocations = 0;
+
+    for (size_t i = 0; i < entries.size();) {
+        if (!entries[i].inUse && frameIndex - entries[i].lastUsedFrame > kMaxIdleFrames) {
+            GGLState->forgetTexture(entries[i].texture);
+            glDeleteTextures(1, &entries[i].texture);
+            entries[i] = entries.back();
+            entries.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
+
+unsigned int RenderTargetPool::allocate(const RenderTargetDesc& desc) {
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    GGLState->bindTexture(0, GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, desc.internalFormat, desc.width, desc.height, 0,
+                 desc.format, desc.type, NULL);
+
+    GLenum filter = (desc.usage == RenderTargetUsage::Depth) ? GL_NEAREST : GL_LINEAR;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GGLState->bindTexture(0, GL_TEXTURE_2D, 0);
+
+    frameAllocations++;
+    totalAllocations++;
+    return texture;
+}
@@ -1,4 +1,7 @@
 #include "Shader.h"
+#include "ShaderCache.h"
+#include "GLExtensions.h"
+#include "GLState.h"
 
 #include <glm/gtc/type_ptr.hpp>
 
@@ -6,6 +9,7 @@
 #include <sstream>
 #include <iostream>
 #include <stdexcept>
+#include <chrono>
 
 #if __has_include(<filesystem>)
   #include <filesystem>
@@ -38,53 +42,138 @@ static std::string ReadTextFileOrThrow(const char* path)
     return content;
 }
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath)
+// Inserts "#define X" lines right after the #version directive
+static std::string InjectDefines(const std::string& source, const std::vector<std::string>& defines)
 {
-    ID = 0;
+    if (defines.empty())
+        return source;
 
-    std::string vertexCode;
-    std::string fragmentCode;
+    std::string block;
+    for (const auto& define : defines)
+        block += "#define " + define + "\n";
 
+    size_t versionPos = source.find("#version");
+    if (versionPos == std::string::npos)
+        return block + source;
+
+    size_t lineEnd = source.find('\n', versionPos);
+    if (lineEnd == std::string::npos)
+        return source + "\n" + block;
+
+    return source.substr(0, lineEnd + 1) + block + source.substr(lineEnd + 1);
+}
+
+bool Shader::readSources(const char* vertexPath, const char* fragmentPath,
+                         const std::vector<std::string>& defines,
+                         std::string& vertexCode, std::string& fragmentCode)
+{
     try
     {
-        vertexCode   = ReadTextFileOrThrow(vertexPath);
-        fragmentCode = ReadTextFileOrThrow(fragmentPath);
+        vertexCode   = InjectDefines(ReadTextFileOrThrow(vertexPath), defines);
+        fragmentCode = InjectDefines(ReadTextFileOrThrow(fragmentPath), defines);
     }
     catch (const std::exception& e)
     {
         std::cerr << "ERROR::SHADER::FILE_READ_FAILED: " << e.what() << "\n";
-        // НІЧОГО не компілюємо, інакше можна зловити crash у драйвері
+        return false;
+    }
+    return true;
+}
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines)
+{
+    ID = 0;
+
+    std::string vertexCode;
+    std::string fragmentCode;
+
+    // НІЧОГО не компілюємо, якщо файл не прочитався, інакше можна зловити crash у драйвері
+    if (!readSources(vertexPath, fragmentPath, defines, vertexCode, fragmentCode))
         return;
+
+    submit(vertexCode, fragmentCode);
+    finish();
+}
+
+// Issues compile and link without reading back any status, so a driver with
+// parallel shader compilation can work on several programs at once
+void Shader::submit(const std::string& vertexCode, const std::string& fragmentCode)
+{
+    if (ShaderCache::isAvailable())
+    {
+        cacheKey = ShaderCache::makeKey({ vertexCode, fragmentCode });
+        ID = ShaderCache::load(cacheKey);
+        if (ID != 0)
+            return;
     }
 
+    auto compileStart = std::chrono::steady_clock::now();
+
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
 
-    unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, nullptr);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
+    vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vShaderCode, nullptr);
+    glCompileShader(vertexShader);
 
-    unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, nullptr);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
+    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &fShaderCode, nullptr);
+    glCompileShader(fragmentShader);
 
     ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
+    ShaderCache::prepare(ID);
+    glAttachShader(ID, vertexShader);
+    glAttachShader(ID, fragmentShader);
     glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
+    pending = true;
 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    ShaderCache::stats.compileMs += std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - compileStart).count();
+}
+
+bool Shader::pollCompletion()
+{
+    if (!pending) return true;
+
+    if (GLExt.parallelShaderCompile)
+    {
+        int done = 0;
+        glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done) return false;
+    }
+
+    finish();
+    return true;
+}
+
+void Shader::finish()
+{
+    if (!pending) return;
+    pending = false;
+
+    auto waitStart = std::chrono::steady_clock::now();
+
+    checkCompileErrors(vertexShader, "VERTEX");
+    checkCompileErrors(fragmentShader, "FRAGMENT");
+    bool linked = checkCompileErrors(ID, "PROGRAM");
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    vertexShader = fragmentShader = 0;
+
+    ShaderCache::stats.compileMs += std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - waitStart).count();
+
+    if (linked && cacheKey != 0)
+        ShaderCache::store(cacheKey, ID);
 }
 
 void Shader::use()
 {
     // якщо шейдер не створився — не падаємо
     if (ID == 0) return;
-    glUseProgram(ID);
+    if (pending) finish();
+    GGLState->useProgram(ID);
 }
 
 void Shader::setBool(const std::string &name, bool value) const {
@@ -102,6 +191,11 @@ void Shader::setFloat(const std::string &name, float value) const {
     glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
 }
 
+void Shader::setMat3(const std::string &name, const glm::mat3 &mat) const {
+    if (ID == 0) return;
+    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+}
+
 void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const {
     if (ID == 0) return;
     glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
@@ -112,7 +206,7 @@ void Shader::setVec3(const std::string &name, const glm::vec3 &value) const {
     glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
 }
 
-void Shader::checkCompileErrors(unsigned int shader, std::string type)
+bool Shader::checkCompileErrors(unsigned int shader, std::string type)
 {
     int success = 0;
     char infoLog[1024];
@@ -139,4 +233,6 @@ void Shader::checkCompileErrors(unsigned int shader, std::string type)
                       << "\n -- --------------------------------------------------- -- \n";
         }
     }
+
+    return success != 0;
 }
@@ -0,0 +1,143 @@
+#include "ShaderCache.h"
+#include "GLExtensions.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#if __has_include(<filesystem>)
+  #include <filesystem>
+#endif
+
+bool ShaderCache::enabled = true;
+std::string ShaderCache::directory = "cache/shaders";
+ShaderCache::Stats ShaderCache::stats;
+
+static const uint32_t kCacheMagic   = 0x42505345; // "ESPB"
+static const uint32_t kCacheVersion = 1;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t length;
+};
+
+// FNV-1a, 64 bit
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static uint64_t hashString(uint64_t hash, const char* text) {
+    // Length first so ("ab","c") and ("a","bc") hash differently
+    size_t length = text ? std::char_traits<char>::length(text) : 0;
+    hash = hashBytes(hash, &length, sizeof(length));
+    return hashBytes(hash, text, length);
+}
+
+bool ShaderCache::isAvailable() {
+    return enabled && GLExt.programBinary;
+}
+
+uint64_t ShaderCache::makeKey(const std::vector<std::string>& sources) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    hash = hashString(hash, (const char*)glGetString(GL_VENDOR));
+    hash = hashString(hash, (const char*)glGetString(GL_RENDERER));
+    hash = hashString(hash, (const char*)glGetString(GL_VERSION));
+
+    for (const auto& source : sources)
+        hash = hashString(hash, source.c_str());
+
+    return hash;
+}
+
+std::string ShaderCache::pathFor(uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return directory + "/" + name;
+}
+
+unsigned int ShaderCache::load(uint64_t key) {
+    if (!isAvailable()) return 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream file(pathFor(key), std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        stats.misses++;
+        return 0;
+    }
+
+    CacheHeader header{};
+    file.read((char*)&header, sizeof(header));
+    if (!file || header.magic != kCacheMagic || header.version != kCacheVersion ||
+        header.key != key || header.length == 0) {
+        stats.misses++;
+        return 0;
+    }
+
+    std::vector<char> binary(header.length);
+    file.read(binary.data(), header.length);
+    if (!file) {
+        stats.misses++;
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    GLExt.ProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)header.length);
+
+    // The driver may reject a binary it produced itself (e.g. after an update it does not report)
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        glDeleteProgram(program);
+        stats.misses++;
+        return 0;
+    }
+
+    stats.hits++;
+    stats.loadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return program;
+}
+
+void ShaderCache::prepare(unsigned int program) {
+    if (isAvailable())
+        GLExt.ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ShaderCache::store(uint64_t key, unsigned int program) {
+    if (!isAvailable()) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum binaryFormat = 0;
+    GLsizei written = 0;
+    GLExt.GetProgramBinary(program, length, &written, &binaryFormat, binary.data());
+    if (written <= 0) return;
+
+#if __has_include(<filesystem>)
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+#endif
+
+    std::ofstream file(pathFor(key), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::SHADER_CACHE:: Cannot write " << pathFor(key) << "\n";
+        return;
+    }
+
+    CacheHeader header{ kCacheMagic, kCacheVersion, key, binaryFormat, (uint32_t)written };
+    file.write((const char*)&header, sizeof(header));
+    file.write(binary.data(), written);
+}
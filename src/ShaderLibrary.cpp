@@ -0,0 +1,52 @@
+#include "ShaderLibrary.h"
+#include "GLExtensions.h"
+#include <algorithm>
+
+ShaderLibrary* GShaderLibrary = nullptr;
+
+ShaderLibrary::ShaderLibrary() {
+    // 0xFFFFFFFF lets the driver pick its own thread count
+    if (GLExt.MaxShaderCompilerThreads)
+        GLExt.MaxShaderCompilerThreads(0xFFFFFFFFu);
+}
+
+std::shared_ptr<Shader> ShaderLibrary::load(const std::string& vertexPath, const std::string& fragmentPath,
+                                            const std::vector<std::string>& defines) {
+    stats.requests++;
+
+    std::string vertexCode;
+    std::string fragmentCode;
+    if (!Shader::readSources(vertexPath.c_str(), fragmentPath.c_str(), defines, vertexCode, fragmentCode))
+        return std::shared_ptr<Shader>(new Shader());
+
+    std::string key = vertexCode;
+    key += '\0';
+    key += fragmentCode;
+
+    auto it = programs.find(key);
+    if (it != programs.end()) {
+        stats.deduplicated++;
+        return it->second;
+    }
+
+    std::shared_ptr<Shader> shader(new Shader());
+    shader->submit(vertexCode, fragmentCode);
+    if (shader->isPending())
+        pending.push_back(shader);
+
+    programs.emplace(std::move(key), shader);
+    stats.programs++;
+    return shader;
+}
+
+void ShaderLibrary::poll() {
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+        [](const std::shared_ptr<Shader>& shader) { return shader->pollCompletion(); }),
+        pending.end());
+}
+
+void ShaderLibrary::finishAll() {
+    for (auto& shader : pending)
+        shader->finish();
+    pending.clear();
+}
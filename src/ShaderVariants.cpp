@@ -0,0 +1,50 @@
+#include "ShaderVariants.h"
+#include "ShaderLibrary.h"
+
+ShaderVariants::ShaderVariants(std::string vertexPath, std::string fragmentPath, std::vector<std::string> featureDefines)
+    : vertexPath(std::move(vertexPath)),
+      fragmentPath(std::move(fragmentPath)),
+      featureDefines(std::move(featureDefines))
+{
+}
+
+ShaderVariants::Variant& ShaderVariants::getVariant(uint32_t features) {
+    auto it = variants.find(features);
+    if (it != variants.end())
+        return it->second;
+
+    std::vector<std::string> defines;
+    for (size_t bit = 0; bit < featureDefines.size(); bit++) {
+        if (features & (1u << bit))
+            defines.push_back(featureDefines[bit]);
+    }
+
+    Variant& variant = variants[features];
+    variant.shader = GShaderLibrary->load(vertexPath, fragmentPath, defines);
+    return variant;
+}
+
+Shader& ShaderVariants::get(uint32_t features) {
+    return *getVariant(features).shader;
+}
+
+Shader& ShaderVariants::select(uint32_t features) {
+    Variant& variant = getVariant(features);
+    variant.shader->use();
+
+    if (variant.setupFrame != frame) {
+        variant.setupFrame = frame;
+        for (auto& setup : frameSetups)
+            setup(*variant.shader);
+    }
+    return *variant.shader;
+}
+
+void ShaderVariants::beginFrame() {
+    frame++;
+    frameSetups.clear();
+}
+
+void ShaderVariants::addFrameSetup(std::function<void(Shader&)> setup) {
+    frameSetups.push_back(std::move(setup));
+}
@@ -1,7 +1,9 @@
 #include "Shape.h"
+#include "ShaderVariants.h"
 
 Shape::Shape() {
     model = glm::mat4(1.0f);
+    normalMatrix = glm::mat3(1.0f);
     color = glm::vec3(1.0f);
 
     position = glm::vec3(0.0f);
@@ -12,14 +14,16 @@ Shape::Shape() {
     useGravity = false;
     isStatic = false;
     hasCollision = true;
-
-    VAO = 0;
-    VBO = 0;
+    touch();
 }
 
 Shape::~Shape() {
-    if (VAO != 0) glDeleteVertexArrays(1, &VAO);
-    if (VBO != 0) glDeleteBuffers(1, &VBO);
+}
+
+// Unique across shapes, so a new shape never repeats an old one's version
+void Shape::touch() {
+    static uint64_t counter = 0;
+    version = ++counter;
 }
 
 void Shape::setPosition(glm::vec3 pos) {
@@ -38,16 +42,35 @@ void Shape::setScale(glm::vec3 scaleVec) {
 }
 
 void Shape::updateModelMatrix() {
+    glm::mat4 previous = model;
     model = glm::mat4(1.0f);
     model = glm::translate(model, position);
     model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
     model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
     model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
     model = glm::scale(model, scale);
+    // Scenes re-set unchanged positions every frame; only real moves count
+    if (model != previous) touch();
+
+    // model = T * R * S, so inverse-transpose of the 3x3 part is R * S^-1:
+    // each column of R * S divided by its scale squared. No per-vertex inverse() needed.
+    normalMatrix = glm::mat3(model);
+    for (int i = 0; i < 3; i++) {
+        float s = scale[i];
+        normalMatrix[i] /= (s != 0.0f) ? s * s : 1.0f;
+    }
+}
+
+void Shape::applyTransform(Shader& shader) const {
+    // Quantized meshes carry their own box transform; the normal matrix is unaffected
+    const Mesh* current = getCurrentMesh();
+    shader.setMat4("model", current ? model * meshTransform * current->getDequantize() : model * meshTransform);
+    shader.setMat3("normalMatrix", normalMatrix);
 }
 
 void Shape::setColor(glm::vec3 newColor) {
     color = newColor;
+    touch();
 }
 
 glm::vec3 Shape::getColor() const {
@@ -55,7 +78,89 @@ glm::vec3 Shape::getColor() const {
 }
 
 void Shape::addTexture(std::shared_ptr<Texture> tex) {
+    if (tex->type == "texture_albedo" && !albedoMap) {
+        materialFeatures |= FEATURE_ALBEDO_MAP;
+        albedoMap = tex;
+    }
     textures.push_back(tex);
+    touch();
+}
+
+void Shape::bindTextures(Shader& shader) const {
+    // Only the albedo map is sampled; the shader variant's material.albedoMap is fixed to unit 0.
+    // Shapes sharing an array skip the rebind and only change the layer uniform.
+    if (!albedoMap) return;
+    albedoMap->bind(0);
+    shader.setFloat("material.albedoLayer", (float)albedoMap->getLayer());
+}
+
+void Shape::requestTextureDetail(const glm::vec3& eye) const {
+    if (!albedoMap) return;
+
+    // Distance to the nearest point of the (unrotated) bounds, so large
+    // shapes like the ground get detail where the camera is close to them
+    glm::vec3 halfExtent = 0.5f * scale;
+    glm::vec3 nearest = glm::clamp(eye, position - halfExtent, position + halfExtent);
+    float worldSize = std::max(scale.x, std::max(scale.y, scale.z)) / uvRepeat;
+    albedoMap->requestDetail(worldSize, glm::length(eye - nearest));
+}
+
+void Shape::selectLod(const LodView& view, LodPass pass) {
+    if (!lods) return;
+
+    float maxScale = std::max(scale.x, std::max(scale.y, scale.z));
+    lodState[pass] = lods->select(position, maxScale, view, lodState[pass]);
+    activeLod = std::min(lodState[pass] + view.bias, (int)lods->levels.size() - 1);
+}
+
+// The selected LOD level, or the single mesh
+const Mesh* Shape::getCurrentMesh() const {
+    if (lods)
+        return lods->levels[activeLod].mesh.get();
+    return mesh.get();
+}
+
+std::vector<std::shared_ptr<Mesh>> Shape::getLodMeshes() const {
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    if (lods) {
+        for (const LodChain::Level& level : lods->levels) meshes.push_back(level.mesh);
+    } else if (mesh) {
+        meshes.push_back(mesh);
+    }
+    return meshes;
+}
+
+void Shape::setVisibleIndices(const Mesh* mesh, unsigned int buffer, size_t byteOffset, int count) {
+    visibleMesh = mesh;
+    visibleBuffer = buffer;
+    visibleOffset = byteOffset;
+    visibleCount = count;
+}
+
+void Shape::drawDepth(Shader& shader) const {
+    const Mesh* current = getCurrentMesh();
+    if (!current) return;
+
+    if (current == visibleMesh) {
+        if (visibleCount == 0) return;
+        applyTransform(shader);
+        current->drawDepthIndices(visibleBuffer, visibleOffset, visibleCount);
+    } else {
+        applyTransform(shader);
+        current->drawDepth();
+    }
+}
+
+void Shape::drawMesh() const {
+    const Mesh* current = getCurrentMesh();
+    if (!current) return;
+
+    if (current == visibleMesh) {
+        if (visibleCount > 0)
+            current->drawIndices(visibleBuffer, visibleOffset, visibleCount);
+    } else {
+        current->draw();
+    }
 }
 
 bool Shape::checkCollision(Shape& other) {
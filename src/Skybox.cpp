@@ -1,111 +1,114 @@
 #include "Skybox.h"
+#include "CubemapBake.h"
+#include "CookedTexture.h"
+#include "ShaderLibrary.h"
+#include "GLState.h"
+#include "Profiler.h"
 #include "stb_image.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
-Skybox::Skybox(const std::string& hdrPath)
-    : shader("src/skybox.vert", "src/skybox.frag")
-{
-    float skyboxVertices[] = {
-        -1.0f,  1.0f, -1.0f,
-        -1.0f, -1.0f, -1.0f,
-         1.0f, -1.0f, -1.0f,
-         1.0f, -1.0f, -1.0f,
-         1.0f,  1.0f, -1.0f,
-        -1.0f,  1.0f, -1.0f,
-
-        -1.0f, -1.0f,  1.0f,
-        -1.0f, -1.0f, -1.0f,
-        -1.0f,  1.0f, -1.0f,
-        -1.0f,  1.0f, -1.0f,
-        -1.0f,  1.0f,  1.0f,
-        -1.0f, -1.0f,  1.0f,
-
-         1.0f, -1.0f, -1.0f,
-         1.0f, -1.0f,  1.0f,
-         1.0f,  1.0f,  1.0f,
-         1.0f,  1.0f,  1.0f,
-         1.0f,  1.0f, -1.0f,
-         1.0f, -1.0f, -1.0f,
-
-        -1.0f, -1.0f,  1.0f,
-        -1.0f,  1.0f,  1.0f,
-         1.0f,  1.0f,  1.0f,
-         1.0f,  1.0f,  1.0f,
-         1.0f, -1.0f,  1.0f,
-        -1.0f, -1.0f,  1.0f,
-
-        -1.0f,  1.0f, -1.0f,
-         1.0f,  1.0f, -1.0f,
-         1.0f,  1.0f,  1.0f,
-         1.0f,  1.0f,  1.0f,
-        -1.0f,  1.0f,  1.0f,
-        -1.0f,  1.0f, -1.0f,
-
-        -1.0f, -1.0f, -1.0f,
-        -1.0f, -1.0f,  1.0f,
-         1.0f, -1.0f, -1.0f,
-         1.0f, -1.0f, -1.0f,
-        -1.0f, -1.0f,  1.0f,
-         1.0f, -1.0f,  1.0f
-    };
+// Roughly one texel per panorama texel at the face centre, as a power of two
+static int faceSizeFor(int panoramaWidth) {
+    int size = 16;
+    while (size * 2 <= panoramaWidth / 4 && size < 2048)
+        size *= 2;
+    return size;
+}
 
+Skybox::Skybox(const std::string& panoramaPath)
+    : shader(GShaderLibrary->load("src/Skybox.vert", "src/skybox.frag"))
+{
+    // The triangle is generated from gl_VertexID; core profile still wants a VAO bound
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    BakedCubemap cubemap;
+    if (!loadCubemap(panoramaPath, cubemap))
+        return;
 
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    GGLState->bindTexture(0, GL_TEXTURE_CUBE_MAP, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    int size = cubemap.faceSize;
+    for (int mip = 0; mip < cubemap.mipCount; mip++) {
+        for (int face = 0; face < 6; face++) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, mip, GL_RGB9_E5, size, size, 0,
+                         GL_RGB, GL_UNSIGNED_INT_5_9_9_9_REV, cubemap.level(mip, face).data());
+        }
+        size = std::max(1, size / 2);
+    }
 
-    stbi_set_flip_vertically_on_load(true);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, cubemap.mipCount - 1);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GGLState->bindTexture(0, GL_TEXTURE_CUBE_MAP, 0);
 
-    int width, height, nrComponents;
-    float *data = stbi_loadf(hdrPath.c_str(), &width, &height, &nrComponents, 0);
+    // Filter across face edges instead of showing the seams
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+}
 
-    if (data) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data);
+// Cached bake if it is newer than the panorama, otherwise decode, bake and cache
+bool Skybox::loadCubemap(const std::string& panoramaPath, BakedCubemap& cubemap) {
+    PROFILE_FUNCTION();
+    std::string cachePath = bakedCubemapPathFor(panoramaPath);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (isCookedUpToDate(panoramaPath, cachePath) && readBakedCubemap(cachePath, cubemap))
+        return true;
 
-        stbi_image_free(data);
-    } else {
-        std::cout << "Failed to load HDR image: " << hdrPath << std::endl;
+    auto start = std::chrono::steady_clock::now();
+
+    stbi_set_flip_vertically_on_load(true);
+    int width, height, nrComponents;
+    float* data = stbi_loadf(panoramaPath.c_str(), &width, &height, &nrComponents, 0);
+    if (!data) {
+        std::cout << "Failed to load HDR image: " << panoramaPath << std::endl;
         std::cout << "Reason: " << stbi_failure_reason() << std::endl;
+        return false;
     }
+
+    cubemap = bakeEquirectCubemap(data, width, height, nrComponents, faceSizeFor(width));
+    stbi_image_free(data);
+    writeBakedCubemap(cachePath, cubemap);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Skybox: baked " << panoramaPath << " (" << width << "x" << height << ") into "
+              << cubemap.faceSize << "px cubemap, " << cubemap.getByteSize() / (1024.0 * 1024.0)
+              << " MB RGB9E5 | " << ms << " ms" << std::endl;
+    return true;
 }
 
 Skybox::~Skybox() {
+    GGLState->forgetVertexArray(VAO);
+    GGLState->forgetTexture(textureID);
     glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
     glDeleteTextures(1, &textureID);
 }
 
 void Skybox::draw(const glm::mat4& view, const glm::mat4& projection) {
-    glDepthFunc(GL_LEQUAL);
+    if (textureID == 0) return;
 
-    glDisable(GL_CULL_FACE);
+    // The triangle sits exactly at the far plane, behind everything already drawn
+    GGLState->depthFunc(GL_LEQUAL);
+    GGLState->depthMask(false);
+    GGLState->setEnabled(GL_CULL_FACE, false);
 
-    shader.use();
+    shader->use();
 
     glm::mat4 viewNoTranslation = glm::mat4(glm::mat3(view));
-    shader.setMat4("view", viewNoTranslation);
-    shader.setMat4("projection", projection);
+    shader->setMat4("inverseViewProjection", glm::inverse(projection * viewNoTranslation));
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    shader.setInt("skyboxHdrMap", 0);
+    GGLState->bindTexture(0, GL_TEXTURE_CUBE_MAP, textureID);
+    shader->setInt("skybox", 0);
 
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    GGLState->bindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
 
-    glDepthFunc(GL_LESS);
-    glEnable(GL_CULL_FACE);
-}
\ No newline at end of file
+    // Later clears only reach the depth buffer with writes on
+    GGLState->depthMask(true);
+    GGLState->depthFunc(GL_LESS);
+}
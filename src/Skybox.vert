@@ -1,14 +1,17 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
+// Fullscreen triangle from gl_VertexID, no vertex buffer
 
-out vec3 WorldPos;
+out vec3 Direction;
 
-uniform mat4 projection;
-uniform mat4 view;
+uniform mat4 inverseViewProjection;
 
 void main()
 {
-    WorldPos = aPos;
-    vec4 pos = projection * view * vec4(aPos, 1.0);
-    gl_Position = pos.xyww;
-}
\ No newline at end of file
+    vec2 ndc = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+
+    // Far plane point under this pixel, back in (rotation-only) view space
+    vec4 world = inverseViewProjection * vec4(ndc, 1.0, 1.0);
+    Direction = world.xyz / world.w;
+
+    gl_Position = vec4(ndc, 1.0, 1.0);
+}
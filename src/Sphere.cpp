@@ -1,10 +1,13 @@
 #include "Sphere.h"
+#include "MeshBuilder.h"
+#include <algorithm>
 #include <vector>
 #include <cmath>
+#include <string>
 
 const float PI = 3.14159265359f;
 
-Sphere::Sphere(float radius, int sectorCount, int stackCount) {
+static std::shared_ptr<Mesh> buildSphereMesh(float radius, int sectorCount, int stackCount) {
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
 
@@ -75,65 +78,24 @@ Sphere::Sphere(float radius, int sectorCount, int stackCount) {
         }
     }
 
-    indexCount = indices.size();
-
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    MeshBuilder builder;
+    builder.addIndexed(vertices, indices);
+    return builder.build();
+}
 
-    glBindVertexArray(0);
+Sphere::Sphere(float radius, int sectorCount, int stackCount) {
+    std::string key = "sphere:" + std::to_string(radius) + ":" + std::to_string(sectorCount) + ":" + std::to_string(stackCount);
+    lods = LodChain::get(key, sectorCount, 8, radius, [=](int sectors) {
+        // Keep the sector/stack ratio of the full level
+        int stacks = std::max(4, stackCount * sectors / sectorCount);
+        return buildSphereMesh(radius, sectors, stacks);
+    });
 }
 
 void Sphere::draw(Shader& shader) {
-    shader.setMat4("model", model);
-
-    shader.setBool("material.hasAlbedo", false);
-    shader.setBool("material.hasNormal", false);
-    shader.setBool("material.hasMetallic", false);
-    shader.setBool("material.hasRoughness", false);
-    shader.setBool("material.hasAO", false);
-
-    for(unsigned int i = 0; i < textures.size(); i++) {
-        std::string name = textures[i]->type;
-
-        if(name == "texture_albedo") {
-            shader.setInt("material.albedoMap", i);
-            shader.setBool("material.hasAlbedo", true);
-        } else if(name == "texture_normal") {
-            shader.setInt("material.normalMap", i);
-            shader.setBool("material.hasNormal", true);
-        } else if(name == "texture_metallic") {
-            shader.setInt("material.metallicMap", i);
-            shader.setBool("material.hasMetallic", true);
-        } else if(name == "texture_roughness") {
-            shader.setInt("material.roughnessMap", i);
-            shader.setBool("material.hasRoughness", true);
-        } else if(name == "texture_ao") {
-            shader.setInt("material.aoMap", i);
-            shader.setBool("material.hasAO", true);
-        }
+    applyTransform(shader);
 
-        textures[i]->bind(i);
-    }
+    bindTextures(shader);
 
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    drawMesh();
 }
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include "StaticBatcher.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+bool StaticBatcher::enabled = true;
+
+static const int kFloatsPerVertex = 8;
+
+// Shapes share a batch when everything the lighting pass sets per shape matches
+struct MaterialKey {
+    uint32_t features;
+    glm::vec3 color;
+    const Texture* albedoMap;
+    bool doubleSided;
+
+    bool operator==(const MaterialKey& o) const {
+        return features == o.features && color == o.color && albedoMap == o.albedoMap && doubleSided == o.doubleSided;
+    }
+};
+
+static uint64_t mixHash(uint64_t hash, uint64_t value) {
+    // FNV-1a over the 8 bytes of value
+    for (int i = 0; i < 8; i++) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool StaticBatcher::update(const std::vector<std::shared_ptr<Shape>>& shapes) {
+    std::vector<Shape*> statics;
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto& shape : shapes) {
+        if (!shape->isStatic || !enabled) {
+            shape->batched = false;
+            continue;
+        }
+        statics.push_back(shape.get());
+        hash = mixHash(hash, (uint64_t)(uintptr_t)shape.get());
+        hash = mixHash(hash, shape->getVersion());
+    }
+    if (hash == signature)
+        return false;
+
+    signature = hash;
+    build(statics);
+    return true;
+}
+
+const StaticBatcher::SourceData& StaticBatcher::sourceFor(const std::shared_ptr<Mesh>& mesh,
+                                                          std::unordered_map<const Mesh*, SourceData>& previous)
+{
+    auto found = sources.find(mesh.get());
+    if (found != sources.end()) return found->second;
+
+    auto reused = previous.find(mesh.get());
+    if (reused != previous.end())
+        return sources.emplace(mesh.get(), std::move(reused->second)).first->second;
+
+    SourceData& source = sources[mesh.get()];
+    source.mesh = mesh;
+    mesh->readBack(source.vertices, source.indices);
+    return source;
+}
+
+void StaticBatcher::build(const std::vector<Shape*>& statics) {
+    PROFILE_FUNCTION();
+    auto start = std::chrono::steady_clock::now();
+
+    for (Shape* shape : statics) shape->batched = false;
+    batches.clear();
+    stats.batches = stats.members = stats.ranges = 0;
+    stats.bytes = 0;
+
+    // Meshes no longer used by any static shape are dropped after this build
+    std::unordered_map<const Mesh*, SourceData> previous;
+    previous.swap(sources);
+
+    std::vector<MaterialKey> keys;
+    std::vector<std::vector<Shape*>> groups;
+    for (Shape* shape : statics) {
+        if (shape->getLodMeshes().empty()) continue;
+        MaterialKey key{ shape->getMaterialFeatures(), shape->getColor(), shape->getAlbedoMap().get(), shape->isDoubleSided() };
+        size_t group = std::find(keys.begin(), keys.end(), key) - keys.begin();
+        if (group == keys.size()) {
+            keys.push_back(key);
+            groups.emplace_back();
+        }
+        groups[group].push_back(shape);
+    }
+
+    for (const std::vector<Shape*>& group : groups) {
+        Batch batch;
+        batch.color = group[0]->getColor();
+        batch.materialFeatures = group[0]->getMaterialFeatures();
+        batch.albedoMap = group[0]->getAlbedoMap();
+        batch.doubleSided = group[0]->isDoubleSided();
+
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+
+        for (Shape* shape : group) {
+            glm::mat4 transform = shape->getMeshMatrix();
+            glm::mat3 linear(transform);
+            glm::mat3 normalMatrix = shape->getNormalMatrix();
+            float scale = std::max(glm::length(linear[0]), std::max(glm::length(linear[1]), glm::length(linear[2])));
+            glm::vec3 shapeScale = shape->scale;
+            // Same rule as MeshletCuller: cones only survive rotation and uniform scale
+            bool cones = !batch.doubleSided && scale > 0.0f &&
+                         shapeScale.x > 0.0f && shapeScale.x == shapeScale.y && shapeScale.y == shapeScale.z;
+
+            Member member;
+            member.shape = shape;
+            for (const std::shared_ptr<Mesh>& mesh : shape->getLodMeshes()) {
+                member.levelStart.push_back(batch.ranges.size());
+
+                const SourceData& source = sourceFor(mesh, previous);
+
+                uint32_t baseVertex = (uint32_t)(vertices.size() / kFloatsPerVertex);
+                uint32_t baseIndex = (uint32_t)indices.size();
+                size_t vertexCount = source.vertices.size() / kFloatsPerVertex;
+
+                glm::vec3 low(INFINITY), high(-INFINITY);
+                for (size_t v = 0; v < vertexCount; v++) {
+                    const float* in = &source.vertices[v * kFloatsPerVertex];
+                    glm::vec3 p = glm::vec3(transform * glm::vec4(in[0], in[1], in[2], 1.0f));
+                    glm::vec3 n = normalMatrix * glm::vec3(in[3], in[4], in[5]);
+                    float length = glm::length(n);
+                    if (length > 0.0f) n /= length;
+                    low = glm::min(low, p);
+                    high = glm::max(high, p);
+                    vertices.insert(vertices.end(), { p.x, p.y, p.z, n.x, n.y, n.z, in[6], in[7] });
+                }
+                for (unsigned int index : source.indices)
+                    indices.push_back(baseVertex + index);
+
+                // Meshlets keep their mesh's index ranges, so their bounds carry over
+                const std::vector<Meshlet>& meshlets = mesh->getMeshlets();
+                if (!meshlets.empty()) {
+                    for (const Meshlet& meshlet : meshlets) {
+                        Range range;
+                        range.firstIndex = baseIndex + meshlet.firstIndex;
+                        range.indexCount = meshlet.indexCount;
+                        range.center = glm::vec3(transform * glm::vec4(meshlet.center, 1.0f));
+                        range.radius = meshlet.radius * scale;
+                        range.coneAxis = cones ? linear * meshlet.coneAxis / scale : meshlet.coneAxis;
+                        range.coneCutoff = cones ? meshlet.coneCutoff : 2.0f;
+                        batch.ranges.push_back(range);
+                    }
+                } else if (!source.indices.empty()) {
+                    Range range;
+                    range.firstIndex = baseIndex;
+                    range.indexCount = (uint32_t)source.indices.size();
+                    range.center = 0.5f * (low + high);
+                    range.radius = 0.5f * glm::length(high - low);
+                    range.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+                    range.coneCutoff = 2.0f;
+                    batch.ranges.push_back(range);
+                }
+            }
+            member.levelStart.push_back(batch.ranges.size());
+            batch.members.push_back(std::move(member));
+            shape->batched = true;
+        }
+
+        batch.mesh = std::make_shared<Mesh>(vertices, indices);
+        stats.batches++;
+        stats.members += (int)batch.members.size();
+        stats.ranges += (int)batch.ranges.size();
+        stats.bytes += batch.mesh->getByteSize();
+        batches.push_back(std::move(batch));
+    }
+    stats.rebuilds++;
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Static batching: " << stats.members << " shapes in " << stats.batches << " batches, "
+              << stats.ranges << " ranges, " << stats.bytes / (1024.0 * 1024.0) << " MB, "
+              << ms << " ms" << std::endl;
+}
+
+void StaticBatcher::collectRanges(const Batch& batch, const CullView& view) {
+    counts.clear();
+    offsets.clear();
+    size_t indexSize = batch.mesh->getIndexSize();
+    uint32_t end = 0;       // one past the last index taken, for merging
+
+    for (const Member& member : batch.members) {
+        int levels = (int)member.levelStart.size() - 1;
+        int level = std::clamp(member.shape->getLodLevel(), 0, levels - 1);
+
+        for (size_t i = member.levelStart[level]; i < member.levelStart[level + 1]; i++) {
+            const Range& range = batch.ranges[i];
+            if (!view.intersectsSphere(range.center, range.radius))
+                continue;
+            if (view.facesAway(range.center, range.radius, range.coneAxis, range.coneCutoff))
+                continue;
+
+            if (!counts.empty() && end == range.firstIndex) {
+                counts.back() += (GLsizei)range.indexCount;
+            } else {
+                counts.push_back((GLsizei)range.indexCount);
+                offsets.push_back((const void*)(uintptr_t)(range.firstIndex * indexSize));
+            }
+            end = range.firstIndex + range.indexCount;
+        }
+    }
+}
+
+void StaticBatcher::draw(ShaderVariants& shaders, uint32_t frameFeatures, const CullView& view) {
+    for (const Batch& batch : batches) {
+        collectRanges(batch, view);
+        if (counts.empty()) continue;
+
+        // Vertices are already in world space
+        Shader& shader = shaders.select(batch.materialFeatures | frameFeatures);
+        shader.setVec3("objectColor", batch.color);
+        shader.setMat4("model", batch.mesh->getDequantize());
+        shader.setMat3("normalMatrix", glm::mat3(1.0f));
+        if (batch.albedoMap) {
+            batch.albedoMap->bind(0);
+            shader.setFloat("material.albedoLayer", (float)batch.albedoMap->getLayer());
+        }
+        batch.mesh->drawRanges(counts, offsets, false);
+    }
+}
+
+void StaticBatcher::drawDepth(Shader& shader, const CullView& view) {
+    for (const Batch& batch : batches) {
+        collectRanges(batch, view);
+        if (counts.empty()) continue;
+
+        shader.setMat4("model", batch.mesh->getDequantize());
+        batch.mesh->drawRanges(counts, offsets, true);
+    }
+}
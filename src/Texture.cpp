@@ -1,43 +1,50 @@
-
 #include "Texture.h"
-#include "stb_image.h"
-#include <iostream>
+#include "TextureLoader.h"
+#include "TextureStreamer.h"
 
-Texture::Texture(const char* path, const std::string& type)
-    : type(type), path(path)
+Texture::Texture(const char* path, const std::string& type, const TextureParams& params)
+    : type(type), path(path), params(params)
 {
-    glGenTextures(1, &ID);
-    glBindTexture(GL_TEXTURE_2D, ID);
+    // Decode and upload happen in the background; see TextureLoader.
+    // Cooked textures start small and get finer levels from the streamer.
+    int initialSize = GTextureStreamer ? GTextureStreamer->getInitialSize() : 0;
+    job = GTextureLoader->request(path, params, initialSize);
+    if (GTextureStreamer)
+        GTextureStreamer->track(job);
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+Texture::~Texture() {
+    if (!job) return;
+    // Also stops a streaming load still in flight
+    job->cancelled = true;
+    GTextureArrays->release(job->slot);
+    GTextureArrays->release(job->uploadSlot);
+    job->slot = {};
+    job->uploadSlot = {};
+}
 
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
+bool Texture::isReady() const {
+    return !job || job->done;
+}
 
-    unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
+size_t Texture::getByteSize() const {
+    return (job && job->done) ? job->residentBytes : 0;
+}
 
-    if (data) {
-        GLenum format = GL_RGB;
-        if (nrChannels == 1) format = GL_RED;
-        else if (nrChannels == 3) format = GL_RGB;
-        else if (nrChannels == 4) format = GL_RGBA;
+void Texture::bind(int unit) {
+    const TextureArraySlot& slot = isReady() ? job->slot : GTextureArrays->getPlaceholder();
+    GTextureArrays->bind(slot.array, unit);
+}
 
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cout << "Texture failed to load: " << path << std::endl;
+void Texture::requestDetail(float worldSize, float distance) {
+    if (GTextureStreamer && job)
+        GTextureStreamer->requestDetail(*job, worldSize, distance);
+}
 
-        unsigned char errorData[] = { 255, 0, 255, 255 };
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, errorData);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    stbi_image_free(data);
+int Texture::getLayer() const {
+    return isReady() ? job->slot.layer : GTextureArrays->getPlaceholder().layer;
 }
 
-void Texture::bind(int unit) {
-    glActiveTexture(GL_TEXTURE0 + unit);
-    glBindTexture(GL_TEXTURE_2D, ID);
-}
\ No newline at end of file
+const TextureArray* Texture::getArray() const {
+    return isReady() ? job->slot.array : GTextureArrays->getPlaceholder().array;
+}
@@ -0,0 +1,203 @@
+#include "TextureArray.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include <algorithm>
+
+TextureArrayPool* GTextureArrays = nullptr;
+
+static int channelsFor(GLenum format) {
+    if (format == GL_RED) return 1;
+    if (format == GL_RG) return 2;
+    if (format == GL_RGB) return 3;
+    return 4;
+}
+
+static int blockBytesFor(GLenum internalFormat) {
+    switch (internalFormat) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+            return 8;
+        default:
+            return 16;
+    }
+}
+
+size_t TextureArrayFormat::levelBytes(int level) const {
+    int w = std::max(1, width >> level);
+    int h = std::max(1, height >> level);
+    if (compressed)
+        return (size_t)((w + 3) / 4) * ((h + 3) / 4) * blockBytesFor(internalFormat);
+    return (size_t)w * h * channelsFor(format);
+}
+
+static TextureArrayFormat solidColorFormat() {
+    TextureArrayFormat format;
+    format.minFilter = GL_NEAREST;
+    format.magFilter = GL_NEAREST;
+    return format;
+}
+
+TextureArrayPool::TextureArrayPool() {
+    // Mid grey: neutral under lighting and easy to tell apart from the magenta error texture
+    unsigned char grey[] = { 128, 128, 128, 255 };
+    placeholder = acquireSolid(grey);
+}
+
+TextureArrayPool::~TextureArrayPool() {
+    for (auto& array : arrays)
+        glDeleteTextures(1, &array->ID);
+}
+
+void TextureArrayPool::allocateStorage(TextureArray& array, int capacity) {
+    const TextureArrayFormat& format = array.format;
+
+    glGenTextures(1, &array.ID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array.ID);
+
+    for (int level = 0; level < format.levels; level++) {
+        int w = std::max(1, format.width >> level);
+        int h = std::max(1, format.height >> level);
+        if (format.compressed) {
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, format.internalFormat, w, h, capacity, 0,
+                                   (GLsizei)(format.levelBytes(level) * capacity), nullptr);
+        } else {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format.internalFormat, w, h, capacity, 0,
+                         format.format, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, format.levels - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, format.wrap);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, format.wrap);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, format.minFilter);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, format.magFilter);
+
+    array.capacity = capacity;
+    array.usedLayers.resize(capacity, false);
+}
+
+// Doubles the layer count. Existing layers are read back into a pixel buffer
+// and copied into the new storage without leaving the GPU.
+void TextureArrayPool::grow(TextureArray& array) {
+    const TextureArrayFormat& format = array.format;
+    unsigned int oldID = array.ID;
+    int oldCapacity = array.capacity;
+
+    allocateStorage(array, std::min(oldCapacity * 2, kMaxLayers));
+    unsigned int newID = array.ID;
+
+    unsigned int buffer;
+    glGenBuffers(1, &buffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (int level = 0; level < format.levels; level++) {
+        int w = std::max(1, format.width >> level);
+        int h = std::max(1, format.height >> level);
+        size_t bytes = format.levelBytes(level) * oldCapacity;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_COPY);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, oldID);
+        if (format.compressed)
+            glGetCompressedTexImage(GL_TEXTURE_2D_ARRAY, level, nullptr);
+        else
+            glGetTexImage(GL_TEXTURE_2D_ARRAY, level, format.format, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, newID);
+        if (format.compressed)
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, w, h, oldCapacity,
+                                      format.internalFormat, (GLsizei)bytes, nullptr);
+        else
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, w, h, oldCapacity,
+                            format.format, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glDeleteBuffers(1, &buffer);
+    glDeleteTextures(1, &oldID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    invalidateBindings();
+}
+
+TextureArraySlot TextureArrayPool::acquire(const TextureArrayFormat& format) {
+    TextureArray* target = nullptr;
+
+    for (auto& array : arrays) {
+        if (!(array->format == format)) continue;
+        if (array->usedCount < array->capacity) {
+            target = array.get();
+            break;
+        }
+        if (array->capacity < kMaxLayers && !target)
+            target = array.get();
+    }
+
+    if (!target) {
+        arrays.push_back(std::make_unique<TextureArray>());
+        target = arrays.back().get();
+        target->format = format;
+        allocateStorage(*target, 1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        invalidateBindings();
+    } else if (target->usedCount == target->capacity) {
+        grow(*target);
+    }
+
+    int layer = (int)(std::find(target->usedLayers.begin(), target->usedLayers.end(), false) - target->usedLayers.begin());
+    target->usedLayers[layer] = true;
+    target->usedCount++;
+    return { target, layer };
+}
+
+TextureArraySlot TextureArrayPool::acquireSolid(const unsigned char rgba[4]) {
+    TextureArraySlot slot = acquire(solidColorFormat());
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, slot.array->ID);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, slot.layer, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    invalidateBindings();
+    return slot;
+}
+
+void TextureArrayPool::release(const TextureArraySlot& slot) {
+    if (!slot.array) return;
+
+    TextureArray* array = slot.array;
+    array->usedLayers[slot.layer] = false;
+    array->usedCount--;
+
+    if (array->usedCount > 0 || array == placeholder.array)
+        return;
+
+    // Names get reused, so forget any binding of the deleted texture
+    glDeleteTextures(1, &array->ID);
+    invalidateBindings();
+    arrays.erase(std::find_if(arrays.begin(), arrays.end(),
+        [array](const std::unique_ptr<TextureArray>& entry) { return entry.get() == array; }));
+}
+
+void TextureArrayPool::bind(const TextureArray* array, int unit) {
+    if (GGLState->bindTexture(unit, GL_TEXTURE_2D_ARRAY, array->ID))
+        bindsIssued++;
+    else
+        bindsSkipped++;
+}
+
+void TextureArrayPool::invalidateBindings() {
+    GGLState->invalidateTextures();
+}
+
+int TextureArrayPool::getLayerCount() const {
+    int layers = 0;
+    for (const auto& array : arrays)
+        layers += array->usedCount;
+    return layers;
+}
@@ -0,0 +1,344 @@
+#include "TextureLoader.h"
+#include "Profiler.h"
+#include "GLExtensions.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+TextureLoader* GTextureLoader = nullptr;
+
+static int decodeThreadCount() {
+    int cores = (int)std::thread::hardware_concurrency();
+    return std::clamp(cores - 1, 1, 4);
+}
+
+static GLenum formatForChannels(int channels) {
+    if (channels == 1) return GL_RED;
+    if (channels == 2) return GL_RG;
+    if (channels == 4) return GL_RGBA;
+    return GL_RGB;
+}
+
+static GLenum internalFormatFor(GLenum format, bool srgb) {
+    switch (format) {
+        case GL_RED:  return GL_R8;
+        case GL_RG:   return GL_RG8;
+        case GL_RGB:  return srgb ? GL_SRGB8 : GL_RGB8;
+        default:      return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    }
+}
+
+static int fullMipCount(int width, int height) {
+    int levels = 1;
+    while ((width | height) >> levels) levels++;
+    return levels;
+}
+
+static TextureArrayFormat arrayFormatFor(const TextureLoadJob& job) {
+    TextureArrayFormat format;
+    format.width = job.width;
+    format.height = job.height;
+    format.wrap = job.params.wrap;
+    format.minFilter = job.params.minFilter;
+    format.magFilter = job.params.magFilter;
+
+    if (job.cooked) {
+        format.levels = (int)job.cooked->mips.size();
+        format.internalFormat = job.compressedFormat;
+        format.compressed = true;
+        format.format = 0;
+    } else {
+        format.levels = fullMipCount(job.width, job.height);
+        format.format = formatForChannels(job.channels);
+        format.internalFormat = internalFormatFor(format.format, job.params.srgb);
+    }
+    return format;
+}
+
+// GL format for a cooked file, 0 when the driver cannot sample it
+static GLenum compressedFormatFor(const CookedTexture& cooked, bool srgb) {
+    switch (cooked.format) {
+        case CookedFormat::BC1:
+            if (srgb) return GLExt.textureCompressionS3TCSrgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : 0;
+            return GLExt.textureCompressionS3TC ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;
+        case CookedFormat::BC4:
+            return GL_COMPRESSED_RED_RGTC1;
+        case CookedFormat::BC5:
+            return GL_COMPRESSED_RG_RGTC2;
+        case CookedFormat::BC7:
+            if (!GLExt.textureCompressionBPTC) return 0;
+            return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+    return 0;
+}
+
+static bool loadCooked(TextureLoadJob& job) {
+    std::string cookedPath = cookedPathFor(job.path);
+    if (!isCookedUpToDate(job.path, cookedPath))
+        return false;
+
+    auto cooked = std::make_unique<CookedTexture>();
+    if (!readCookedTexture(cookedPath, *cooked, job.maxLoadSize))
+        return false;
+
+    job.compressedFormat = compressedFormatFor(*cooked, job.params.srgb);
+    if (job.compressedFormat == 0)
+        return false;
+
+    job.cooked = std::move(cooked);
+    return true;
+}
+
+// Main thread: the streaming fields are read by GTextureStreamer between loads
+static void applyCookedLayout(TextureLoadJob& job) {
+    const CookedTexture& cooked = *job.cooked;
+    job.width = cooked.mips[0].width;
+    job.height = cooked.mips[0].height;
+    job.baseWidth = cooked.baseWidth;
+    job.baseHeight = cooked.baseHeight;
+    job.mipCount = cooked.mipCount;
+    job.blockBytes = cookedBlockBytes(cooked.format);
+    job.loadingMip = cooked.firstMip;
+}
+
+TextureLoader::TextureLoader(size_t uploadBudgetBytes)
+    : pool(std::make_unique<ThreadPool>(decodeThreadCount(), "Texture decode")),
+      uploadBudget(uploadBudgetBytes)
+{
+    glGenBuffers(2, pbos);
+}
+
+TextureLoader::~TextureLoader() {
+    // Join the workers before anything they touch goes away
+    pool.reset();
+
+    for (auto& job : decoded) stbi_image_free(job->pixels);
+    for (auto& job : uploads) stbi_image_free(job->pixels);
+
+    glDeleteBuffers(2, pbos);
+}
+
+std::shared_ptr<TextureLoadJob> TextureLoader::request(const std::string& path, const TextureParams& params, int maxSize) {
+    auto job = std::make_shared<TextureLoadJob>();
+    job->path = path;
+    job->params = params;
+    job->maxLoadSize = maxSize;
+
+    submit(job);
+    return job;
+}
+
+void TextureLoader::requestMips(const std::shared_ptr<TextureLoadJob>& job, int firstMip) {
+    if (!job->done || job->mipCount == 0 || job->loadingMip >= 0)
+        return;
+
+    // Level sizes halve down to 1, so the level's own size selects exactly it
+    int levelSize = std::max(job->baseWidth, job->baseHeight) >> firstMip;
+    job->maxLoadSize = std::max(1, levelSize);
+    job->loadingMip = firstMip;
+
+    submit(job);
+}
+
+void TextureLoader::submit(const std::shared_ptr<TextureLoadJob>& job) {
+    bool restream = job->done;
+
+    inFlight++;
+    pool->submit([this, job, restream] {
+        // A streamed texture never falls back to the source image
+        if (!job->cancelled && !loadCooked(*job) && !restream) {
+            PROFILE_SCOPE("Texture decode");
+            stbi_set_flip_vertically_on_load_thread(true);
+            job->pixels = stbi_load(job->path.c_str(), &job->width, &job->height, &job->channels, 0);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.push_back(job);
+            inFlight--;
+        }
+        decodedReady.notify_all();
+    });
+}
+
+void TextureLoader::collectDecoded() {
+    std::vector<std::shared_ptr<TextureLoadJob>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(decoded);
+    }
+
+    for (auto& job : ready) {
+        if (job->cancelled) {
+            stbi_image_free(job->pixels);
+            job->pixels = nullptr;
+            continue;
+        }
+        if (!job->cooked && !job->pixels) {
+            std::cout << "Texture failed to load: " << job->path << std::endl;
+            if (job->done) {
+                // Failed re-stream: keep the levels already resident
+                job->loadingMip = -1;
+                continue;
+            }
+            complete(*job);
+            continue;
+        }
+
+        if (job->cooked)
+            applyCookedLayout(*job);
+        job->uploadSlot = GTextureArrays->acquire(arrayFormatFor(*job));
+        uploads.push_back(job);
+    }
+}
+
+// Copies as many whole rows as fit in byteBudget (at least one) through the next PBO
+size_t TextureLoader::uploadRows(TextureLoadJob& job, size_t byteBudget) {
+    size_t rowBytes = (size_t)job.width * job.channels;
+    // Clamp before narrowing: a large budget must not wrap the row count
+    int rows = (int)std::min<size_t>(std::max<size_t>(1, byteBudget / rowBytes), job.height - job.rowsUploaded);
+    size_t bytes = rowBytes * rows;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    nextPbo = (nextPbo + 1) % 2;
+
+    // Orphan the previous storage so the driver never waits on an upload still in flight
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst) {
+        std::memcpy(dst, job.pixels + rowBytes * job.rowsUploaded, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, job.uploadSlot.array->ID);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, job.rowsUploaded, job.uploadSlot.layer, job.width, rows, 1,
+                        formatForChannels(job.channels), GL_UNSIGNED_BYTE, nullptr);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    job.rowsUploaded += rows;
+    return bytes;
+}
+
+// One whole mip level of a cooked texture through the next PBO
+size_t TextureLoader::uploadCookedMip(TextureLoadJob& job) {
+    const CookedMip& mip = job.cooked->mips[job.mipsUploaded];
+    size_t bytes = mip.data.size();
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    nextPbo = (nextPbo + 1) % 2;
+
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst) {
+        std::memcpy(dst, mip.data.data(), bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, job.uploadSlot.array->ID);
+        glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, job.mipsUploaded, 0, 0, job.uploadSlot.layer,
+                                  mip.width, mip.height, 1, job.compressedFormat, (GLsizei)bytes, nullptr);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    job.mipsUploaded++;
+    return bytes;
+}
+
+void TextureLoader::complete(TextureLoadJob& job) {
+    if (job.cooked || job.pixels) {
+        GTextureArrays->release(job.slot);
+        job.slot = job.uploadSlot;
+        job.uploadSlot = {};
+    }
+
+    if (job.cooked) {
+        // The chain is precomputed and the array already has the matching level count
+        job.residentBytes = job.cooked->getByteSize();
+        job.residentMip = job.loadingMip;
+        job.loadingMip = -1;
+        job.mipsUploaded = 0;
+        job.cooked.reset();
+    } else if (job.pixels) {
+        // Regenerates every layer of the array; loads are rare enough for that
+        glBindTexture(GL_TEXTURE_2D_ARRAY, job.slot.array->ID);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        stbi_image_free(job.pixels);
+        job.pixels = nullptr;
+
+        // Full mip chain adds a third on top of the base level
+        job.residentBytes = (size_t)job.width * job.height * job.channels * 4 / 3;
+    } else {
+        unsigned char errorData[] = { 255, 0, 255, 255 };
+        job.slot = GTextureArrays->acquireSolid(errorData);
+        job.residentBytes = 4;
+    }
+    job.done = true;
+}
+
+void TextureLoader::update() {
+    PROFILE_FUNCTION();
+
+    collectDecoded();
+
+    frameUploadBytes = 0;
+    uploadPending(false);
+}
+
+// Uploads queued jobs until the frame budget is spent, or all of them when draining
+void TextureLoader::uploadPending(bool drain) {
+    if (uploads.empty()) return;
+
+    // Rows of RGB images are not 4-byte aligned in general
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    while (!uploads.empty() && (drain || frameUploadBytes < uploadBudget)) {
+        TextureLoadJob& job = *uploads.front();
+
+        if (job.cancelled) {
+            stbi_image_free(job.pixels);
+            job.pixels = nullptr;
+            uploads.pop_front();
+            continue;
+        }
+
+        if (job.cooked) {
+            frameUploadBytes += uploadCookedMip(job);
+            if (job.mipsUploaded >= (int)job.cooked->mips.size()) {
+                complete(job);
+                uploads.pop_front();
+            }
+            continue;
+        }
+
+        size_t remaining = (size_t)job.width * job.channels * (job.height - job.rowsUploaded);
+        frameUploadBytes += uploadRows(job, drain ? remaining : uploadBudget - frameUploadBytes);
+
+        if (job.rowsUploaded >= job.height) {
+            complete(job);
+            uploads.pop_front();
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    GTextureArrays->invalidateBindings();
+}
+
+void TextureLoader::finishAll() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            decodedReady.wait(lock, [this] { return inFlight == 0 || !decoded.empty(); });
+        }
+
+        collectDecoded();
+        uploadPending(true);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (inFlight == 0 && decoded.empty() && uploads.empty())
+            break;
+    }
+}
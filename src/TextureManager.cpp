@@ -0,0 +1,54 @@
+#include "TextureManager.h"
+#include <filesystem>
+
+TextureManager* GTextureManager = nullptr;
+
+std::string TextureManager::makeKey(const std::string& path, const std::string& type, const TextureParams& params) {
+    // "assets/x.jpg" and "./assets/../assets/x.jpg" are the same file
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+    std::string key = error ? path : canonical.string();
+
+    key += '|';
+    key += type;
+    key += '|' + std::to_string(params.wrap) +
+           '|' + std::to_string(params.minFilter) +
+           '|' + std::to_string(params.magFilter) +
+           '|' + (params.srgb ? "srgb" : "linear");
+    return key;
+}
+
+std::shared_ptr<Texture> TextureManager::load(const std::string& path, const std::string& type,
+                                              const TextureParams& params) {
+    std::string key = makeKey(path, type, params);
+
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        if (std::shared_ptr<Texture> texture = it->second.lock()) {
+            stats.hits++;
+            return texture;
+        }
+    }
+
+    stats.misses++;
+    auto texture = std::make_shared<Texture>(path.c_str(), type, params);
+    entries[key] = texture;
+    return texture;
+}
+
+const TextureManager::Stats& TextureManager::getStats() {
+    stats.residentTextures = 0;
+    stats.residentBytes = 0;
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        std::shared_ptr<Texture> texture = it->second.lock();
+        if (!texture) {
+            it = entries.erase(it);
+            continue;
+        }
+        stats.residentTextures++;
+        stats.residentBytes += texture->getByteSize();
+        ++it;
+    }
+    return stats;
+}
@@ -0,0 +1,159 @@
+#include "TextureStreamer.h"
+#include "TextureLoader.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+TextureStreamer* GTextureStreamer = nullptr;
+
+// GPU bytes of the chain from firstMip down to 1x1
+static size_t chainBytes(const TextureLoadJob& job, int firstMip) {
+    size_t total = 0;
+    for (int level = std::max(firstMip, 0); level < job.mipCount; level++) {
+        int w = std::max(1, job.baseWidth >> level);
+        int h = std::max(1, job.baseHeight >> level);
+        total += (size_t)((w + 3) / 4) * ((h + 3) / 4) * job.blockBytes;
+    }
+    return total;
+}
+
+// Only done cooked textures with no load in flight can change level
+static bool isIdle(const TextureLoadJob& job) {
+    return job.done && job.mipCount > 0 && job.residentMip >= 0 && job.loadingMip < 0;
+}
+
+TextureStreamer::TextureStreamer(size_t budgetBytes, int initialSize)
+    : budget(budgetBytes), initialSize(initialSize)
+{
+}
+
+void TextureStreamer::track(const std::shared_ptr<TextureLoadJob>& job) {
+    jobs.push_back(job);
+}
+
+int TextureStreamer::startMip(const TextureLoadJob& job) const {
+    int level = 0;
+    while (level + 1 < job.mipCount && std::max(job.baseWidth, job.baseHeight) >> level > initialSize)
+        level++;
+    return level;
+}
+
+void TextureStreamer::beginFrame(const glm::mat4& projection, int viewportHeight) {
+    // Pixels covered by one world unit at distance 1
+    pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;
+}
+
+void TextureStreamer::requestDetail(TextureLoadJob& job, float worldSize, float distance) {
+    if (job.mipCount == 0) return;
+
+    // One texel per pixel: every halving of the on-screen size drops a level
+    float pixels = worldSize * pixelsPerUnit / std::max(distance, 0.01f);
+    float texels = (float)std::max(job.baseWidth, job.baseHeight);
+    int mip = pixels > 0.0f ? (int)std::floor(std::log2(texels / pixels)) : job.mipCount - 1;
+    mip = std::clamp(mip, 0, job.mipCount - 1);
+
+    if (job.lastUsedFrame != frame) {
+        job.lastUsedFrame = frame;
+        job.requestedMip = mip;
+    } else {
+        job.requestedMip = std::min(job.requestedMip, mip);
+    }
+}
+
+// Least recently used texture above its starting level; failing that, one
+// used this frame that holds finer levels than it asked for
+std::shared_ptr<TextureLoadJob> TextureStreamer::findVictim() {
+    std::shared_ptr<TextureLoadJob> victim;
+    std::shared_ptr<TextureLoadJob> overResident;
+
+    for (const auto& weak : jobs) {
+        auto job = weak.lock();
+        if (!job || !isIdle(*job)) continue;
+
+        if (job->lastUsedFrame != frame) {
+            if (job->residentMip < startMip(*job) && (!victim || job->lastUsedFrame < victim->lastUsedFrame))
+                victim = job;
+        } else if (job->residentMip < job->requestedMip && !overResident) {
+            overResident = job;
+        }
+    }
+    return victim ? victim : overResident;
+}
+
+void TextureStreamer::update() {
+    PROFILE_FUNCTION();
+
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [](const std::weak_ptr<TextureLoadJob>& weak) {
+        auto job = weak.lock();
+        return !job || job->cancelled;
+    }), jobs.end());
+
+    // Bytes the GPU holds once every load in flight lands
+    size_t committed = 0;
+    std::vector<std::shared_ptr<TextureLoadJob>> wanting;
+    for (const auto& weak : jobs) {
+        auto job = weak.lock();
+        if (job->mipCount == 0) continue;
+
+        committed += chainBytes(*job, job->loadingMip >= 0 ? job->loadingMip : job->residentMip);
+        if (isIdle(*job) && job->lastUsedFrame == frame && job->requestedMip < job->residentMip)
+            wanting.push_back(job);
+    }
+
+    // Blurriest first
+    std::sort(wanting.begin(), wanting.end(), [](const auto& a, const auto& b) {
+        return a->residentMip - a->requestedMip > b->residentMip - b->requestedMip;
+    });
+
+    int loads = 0;
+    for (const auto& job : wanting) {
+        if (loads >= maxLoadsPerFrame) break;
+
+        size_t current = chainBytes(*job, job->residentMip);
+        int target = job->requestedMip;
+
+        while (committed + chainBytes(*job, target) - current > budget) {
+            auto victim = findVictim();
+            if (!victim) break;
+
+            int victimTarget = (victim->lastUsedFrame == frame) ? victim->requestedMip : startMip(*victim);
+            committed -= chainBytes(*victim, victim->residentMip) - chainBytes(*victim, victimTarget);
+            GTextureLoader->requestMips(victim, victimTarget);
+            stats.streamOuts++;
+        }
+
+        // Settle for the finest level that still fits
+        while (target < job->residentMip && committed + chainBytes(*job, target) - current > budget)
+            target++;
+        if (target >= job->residentMip) continue;
+
+        committed += chainBytes(*job, target) - current;
+        GTextureLoader->requestMips(job, target);
+        stats.streamIns++;
+        loads++;
+    }
+
+    frame++;
+}
+
+const TextureStreamer::Stats& TextureStreamer::getStats() {
+    stats.streamedTextures = 0;
+    stats.residentBytes = 0;
+    stats.requestedBytes = 0;
+    stats.budgetBytes = budget;
+    stats.loading = 0;
+
+    for (const auto& weak : jobs) {
+        auto job = weak.lock();
+        if (!job || job->mipCount == 0) continue;
+
+        if (job->loadingMip >= 0) stats.loading++;
+        if (job->residentMip < 0) continue;
+
+        stats.streamedTextures++;
+        stats.residentBytes += chainBytes(*job, job->residentMip);
+        bool used = job->lastUsedFrame >= 0 && job->lastUsedFrame >= frame - 1;
+        stats.requestedBytes += chainBytes(*job, used ? job->requestedMip : startMip(*job));
+    }
+    return stats;
+}
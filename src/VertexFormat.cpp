@@ -0,0 +1,272 @@
+#include "VertexFormat.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+bool VertexFormat::compactByDefault = true;
+
+VertexFormat::VertexFormat(PositionEncoding position, NormalEncoding normal, TexCoordEncoding texCoord)
+    : position(position), normal(normal), texCoord(texCoord)
+{
+    auto add = [&](GLuint location, GLint components, GLenum type, GLboolean normalized, unsigned int size) {
+        attributes.push_back({ location, components, type, normalized, stride, size });
+        stride += size;
+    };
+
+    switch (position) {
+        case PositionEncoding::FLOAT32: add(0, 3, GL_FLOAT, GL_FALSE, 12); break;
+        case PositionEncoding::HALF:    add(0, 3, GL_HALF_FLOAT, GL_FALSE, 8); break;
+        case PositionEncoding::SNORM16: add(0, 3, GL_SHORT, GL_TRUE, 8); break;
+    }
+    switch (normal) {
+        case NormalEncoding::FLOAT32:          add(1, 3, GL_FLOAT, GL_FALSE, 12); break;
+        case NormalEncoding::SNORM_10_10_10_2: add(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, 4); break;
+    }
+    switch (texCoord) {
+        case TexCoordEncoding::FLOAT32: add(2, 2, GL_FLOAT, GL_FALSE, 8); break;
+        case TexCoordEncoding::HALF:    add(2, 2, GL_HALF_FLOAT, GL_FALSE, 4); break;
+    }
+}
+
+const VertexFormat& VertexFormat::full() {
+    static const VertexFormat format(PositionEncoding::FLOAT32, NormalEncoding::FLOAT32, TexCoordEncoding::FLOAT32);
+    return format;
+}
+
+const VertexFormat& VertexFormat::compact() {
+    static const VertexFormat format(PositionEncoding::SNORM16, NormalEncoding::SNORM_10_10_10_2, TexCoordEncoding::HALF);
+    return format;
+}
+
+const VertexFormat& VertexFormat::getDefault() {
+    return compactByDefault ? compact() : full();
+}
+
+// Round-to-nearest-even float -> IEEE half; out-of-range values become infinity
+uint16_t packHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent >= 31) {
+        bool isNan = ((bits >> 23) & 0xFF) == 0xFF && mantissa != 0;
+        return (uint16_t)(sign | 0x7C00 | (isNan ? 0x200 : 0));
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) return (uint16_t)sign;
+        // Denormal: shift the implicit one in and round
+        mantissa |= 0x800000;
+        int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t midpoint = 1u << (shift - 1);
+        if (rest > midpoint || (rest == midpoint && (half & 1))) half++;
+        return (uint16_t)(sign | half);
+    }
+
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++;   // may carry into the exponent, which is correct
+    return (uint16_t)half;
+}
+
+float unpackHalf(uint16_t value) {
+    uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+
+    uint32_t bits;
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    } else if (mantissa != 0) {
+        // Denormal: normalize into a float exponent
+        int shift = 0;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            shift++;
+        }
+        bits = sign | ((uint32_t)(127 - 15 + 1 - shift) << 23) | ((mantissa & 0x3FF) << 13);
+    } else {
+        bits = sign;
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+static int16_t packSnorm16(float value) {
+    return (int16_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+static uint32_t packSnorm10(float value) {
+    return (uint32_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 511.0f) & 0x3FF;
+}
+
+std::vector<uint8_t> VertexFormat::pack(const std::vector<float>& vertices, glm::mat4& dequantize) const {
+    size_t vertexCount = vertices.size() / 8;
+
+    // Quantized positions are stored relative to the bounding box, scaled into [-1, 1]
+    glm::vec3 center(0.0f), extent(1.0f);
+    if (isQuantized() && vertexCount > 0) {
+        glm::vec3 lo(vertices[0], vertices[1], vertices[2]), hi = lo;
+        for (size_t i = 0; i < vertexCount; i++) {
+            glm::vec3 p(vertices[i * 8], vertices[i * 8 + 1], vertices[i * 8 + 2]);
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+        center = (lo + hi) * 0.5f;
+        extent = glm::max((hi - lo) * 0.5f, glm::vec3(1e-6f));
+    }
+    dequantize = glm::scale(glm::translate(glm::mat4(1.0f), center), extent);
+
+    std::vector<uint8_t> packed(vertexCount * stride, 0);
+    for (size_t i = 0; i < vertexCount; i++) {
+        const float* v = &vertices[i * 8];
+        uint8_t* out = &packed[i * stride];
+
+        switch (position) {
+            case PositionEncoding::FLOAT32:
+                std::memcpy(out, v, 12);
+                out += 12;
+                break;
+            case PositionEncoding::HALF:
+            case PositionEncoding::SNORM16: {
+                uint16_t p[4] = { 0, 0, 0, 0 };
+                for (int c = 0; c < 3; c++) {
+                    float q = (v[c] - center[c]) / extent[c];
+                    p[c] = (position == PositionEncoding::HALF) ? packHalf(q) : (uint16_t)packSnorm16(q);
+                }
+                std::memcpy(out, p, 8);
+                out += 8;
+                break;
+            }
+        }
+
+        switch (normal) {
+            case NormalEncoding::FLOAT32:
+                std::memcpy(out, v + 3, 12);
+                out += 12;
+                break;
+            case NormalEncoding::SNORM_10_10_10_2: {
+                uint32_t n = packSnorm10(v[3]) | (packSnorm10(v[4]) << 10) | (packSnorm10(v[5]) << 20);
+                std::memcpy(out, &n, 4);
+                out += 4;
+                break;
+            }
+        }
+
+        switch (texCoord) {
+            case TexCoordEncoding::FLOAT32:
+                std::memcpy(out, v + 6, 8);
+                break;
+            case TexCoordEncoding::HALF: {
+                uint16_t uv[2] = { packHalf(v[6]), packHalf(v[7]) };
+                std::memcpy(out, uv, 4);
+                break;
+            }
+        }
+    }
+    return packed;
+}
+
+// GL's snorm conversion: the most negative value clamps to -1
+static float unpackSnorm16(int16_t value) {
+    return std::max((float)value / 32767.0f, -1.0f);
+}
+
+static float unpackSnorm10(uint32_t bits) {
+    int value = (int)(bits & 0x3FF);
+    if (value & 0x200) value -= 0x400;
+    return std::max((float)value / 511.0f, -1.0f);
+}
+
+std::vector<float> VertexFormat::unpack(const uint8_t* packed, size_t vertexCount, const glm::mat4& dequantize) const {
+    std::vector<float> vertices(vertexCount * 8);
+    for (size_t i = 0; i < vertexCount; i++) {
+        const uint8_t* in = packed + i * stride;
+        float* v = &vertices[i * 8];
+
+        switch (position) {
+            case PositionEncoding::FLOAT32:
+                std::memcpy(v, in, 12);
+                in += 12;
+                break;
+            case PositionEncoding::HALF:
+            case PositionEncoding::SNORM16: {
+                uint16_t p[3];
+                std::memcpy(p, in, 6);
+                for (int c = 0; c < 3; c++)
+                    v[c] = (position == PositionEncoding::HALF) ? unpackHalf(p[c]) : unpackSnorm16((int16_t)p[c]);
+                in += 8;
+                break;
+            }
+        }
+        glm::vec3 p = glm::vec3(dequantize * glm::vec4(v[0], v[1], v[2], 1.0f));
+        v[0] = p.x; v[1] = p.y; v[2] = p.z;
+
+        switch (normal) {
+            case NormalEncoding::FLOAT32:
+                std::memcpy(v + 3, in, 12);
+                in += 12;
+                break;
+            case NormalEncoding::SNORM_10_10_10_2: {
+                uint32_t n;
+                std::memcpy(&n, in, 4);
+                for (int c = 0; c < 3; c++) v[3 + c] = unpackSnorm10(n >> (10 * c));
+                in += 4;
+                break;
+            }
+        }
+
+        switch (texCoord) {
+            case TexCoordEncoding::FLOAT32:
+                std::memcpy(v + 6, in, 8);
+                break;
+            case TexCoordEncoding::HALF: {
+                uint16_t uv[2];
+                std::memcpy(uv, in, 4);
+                v[6] = unpackHalf(uv[0]);
+                v[7] = unpackHalf(uv[1]);
+                break;
+            }
+        }
+    }
+    return vertices;
+}
+
+unsigned int VertexFormat::getPositionStride() const {
+    return position == PositionEncoding::FLOAT32 ? 12 : 8;
+}
+
+std::vector<uint8_t> VertexFormat::extractPositions(const std::vector<uint8_t>& packed) const {
+    size_t vertexCount = packed.size() / stride;
+    unsigned int positionStride = getPositionStride();
+
+    // The interleaved position already spans positionStride bytes, padding included
+    std::vector<uint8_t> positions(vertexCount * positionStride);
+    for (size_t i = 0; i < vertexCount; i++)
+        std::memcpy(&positions[i * positionStride], &packed[i * stride + attributes[0].offset], positionStride);
+    return positions;
+}
+
+void VertexFormat::applyPositions() const {
+    const VertexAttribute& attribute = attributes[0];
+    glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized,
+                          getPositionStride(), (void*)0);
+    glEnableVertexAttribArray(attribute.location);
+}
+
+void VertexFormat::apply() const {
+    for (const VertexAttribute& attribute : attributes) {
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized,
+                              stride, (void*)(uintptr_t)attribute.offset);
+        glEnableVertexAttribArray(attribute.location);
+    }
+}
@@ -6,21 +6,32 @@ in vec3 Normal;
 in vec2 TexCoords;
 in vec4 FragPosLightSpace;
 
+// Variants: HAS_ALBEDO_MAP, ENABLE_LIGHTING, ENABLE_SHADOWS, GPU_DRIVEN (see ShaderVariants)
+
+#ifdef GPU_DRIVEN
+flat in vec4 DrawMaterial;  // rgb object color, a albedo layer
+#endif
+
+#ifdef HAS_ALBEDO_MAP
 struct Material {
-    sampler2D albedoMap;
-    bool hasAlbedo;
+    sampler2DArray albedoMap;   // shared texture array, see TextureArrayPool
+    float albedoLayer;
 };
 
 uniform Material material;
-uniform sampler2DShadow shadowMap;
+#endif
 
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 uniform vec3 lightColor;
+#ifdef GPU_DRIVEN
+#define objectColor DrawMaterial.rgb
+#else
 uniform vec3 objectColor;
+#endif
 
-uniform int enableLighting;
-uniform int enableShadows;
+#if defined(ENABLE_LIGHTING) && defined(ENABLE_SHADOWS)
+uniform sampler2DShadow shadowMap;
 
 // Shadow calculation
 float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
@@ -56,16 +67,24 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
     shadow /= 9.0;
     return 1.0 - shadow;
 }
+#endif
 
 
 
 void main()
 {
     // Albedo
+#ifdef HAS_ALBEDO_MAP
+#ifdef GPU_DRIVEN
+    vec3 albedo = texture(material.albedoMap, vec3(TexCoords, DrawMaterial.a)).rgb;
+#else
+    vec3 albedo = texture(material.albedoMap, vec3(TexCoords, material.albedoLayer)).rgb;
+#endif
+#else
     vec3 albedo = objectColor;
-    if (material.hasAlbedo)
-        albedo = texture(material.albedoMap, TexCoords).rgb;
+#endif
 
+#ifdef ENABLE_LIGHTING
     // Vectors
     vec3 N = normalize(Normal);
     vec3 L = normalize(lightPos - FragPos);
@@ -93,21 +112,15 @@ void main()
     vec3 specular = attenuation * ks * spec * lightColor;
 
     // Shadow
-    //float shadow = ShadowCalculation(FragPosLightSpace, N, L);
     float shadow = 0.0;
-    if (enableShadows == 1)
-        shadow = ShadowCalculation(FragPosLightSpace, N, L);
-
-
-    //vec3 color = ambient + (diffuse + specular) * (1.0 - shadow);
-    //FragColor = vec4(color, 1.0);
-    vec3 color;
-
-    if (enableLighting == 1) {
-        color = ambient + (diffuse + specular) * (1.0 - shadow);
-    } else {
-        color = albedo; // без освітлення — чистий колір
-    }
+#ifdef ENABLE_SHADOWS
+    shadow = ShadowCalculation(FragPosLightSpace, N, L);
+#endif
+
+    vec3 color = ambient + (diffuse + specular) * (1.0 - shadow);
+#else
+    vec3 color = albedo; // без освітлення — чистий колір
+#endif
 
     FragColor = vec4(color, 1.0);
 
@@ -8,17 +8,36 @@ out vec3 Normal;
 out vec2 TexCoords;
 out vec4 FragPosLightSpace;
 
+// The depth pre-pass reuses this shader; GL_EQUAL needs bit-identical depth
+invariant gl_Position;
+
+#ifdef GPU_DRIVEN
+// Per-draw data written by the culling pass; each indirect draw is one
+// instance whose baseInstance selects its row (see GpuDrivenRenderer)
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in mat3 aNormalMatrix;
+layout (location = 10) in vec4 aMaterial;
+
+flat out vec4 DrawMaterial;
+#else
 uniform mat4 model;
+uniform mat3 normalMatrix;
+#endif
 uniform mat4 view;
 uniform mat4 projection;
 uniform mat4 lightSpaceMatrix;
 
 void main()
 {
+#ifdef GPU_DRIVEN
+    mat4 model = aModel;
+    mat3 normalMatrix = aNormalMatrix;
+    DrawMaterial = aMaterial;
+#endif
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = normalize(transpose(inverse(mat3(model))) * aNormal);
+    Normal = normalize(normalMatrix * aNormal);
     TexCoords = aTexCoords;
 
     FragPosLightSpace = lightSpaceMatrix * vec4(FragPos, 1.0);
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+    gl_Position = projection * (view * vec4(FragPos, 1.0));
 }
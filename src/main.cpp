@@ -1,15 +1,61 @@
 #include "Engine.h"
+#include "Profiler.h"
 #include "scenes/include/DemoPhysics.h"
+#include "ShaderCache.h"
+#include "VertexFormat.h"
 #include <iostream>
 #include <filesystem>
 #include <memory>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
 
-int main() {
+int main(int argc, char** argv) {
+    PROFILE_INIT();
     std::cout << "REAL CWD = " << std::filesystem::current_path() << std::endl;
 
+    // --headless [--frames N] [--size WxH] [--screenshot out.ppm]: offscreen benchmark run
+    // --texture-budget MB: GPU memory for streamed texture levels
+    // --full-vertices: 32-byte float vertices instead of the packed 16-byte format
+    // --no-cluster-culling: draw imported meshes whole instead of their visible meshlets
+    // --no-static-batching: draw static shapes one by one
+    // --gpu-driven: cull and pick LODs in a compute shader, draw with multi-draw indirect
+    bool headless = false;
+    const char* screenshot = nullptr;
+    int frames = 600;
+    int width = 1920, height = 1080;
+    int textureBudgetMB = 256;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            std::sscanf(argv[++i], "%dx%d", &width, &height);
+        } else if (std::strcmp(argv[i], "--screenshot") == 0 && i + 1 < argc) {
+            screenshot = argv[++i];
+        } else if (std::strcmp(argv[i], "--no-shader-cache") == 0) {
+            ShaderCache::enabled = false;
+        } else if (std::strcmp(argv[i], "--texture-budget") == 0 && i + 1 < argc) {
+            textureBudgetMB = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--full-vertices") == 0) {
+            VertexFormat::compactByDefault = false;
+        } else if (std::strcmp(argv[i], "--no-cluster-culling") == 0) {
+            MeshletCuller::enabled = false;
+        } else if (std::strcmp(argv[i], "--no-static-batching") == 0) {
+            StaticBatcher::enabled = false;
+        } else if (std::strcmp(argv[i], "--gpu-driven") == 0) {
+            GpuDrivenRenderer::enabled = true;
+        }
+    }
+
     Engine engine;
+    engine.textureBudgetBytes = (size_t)textureBudgetMB * 1024 * 1024;
 
-    if (engine.init(1920, 1080, "3D Engine") != 0) {
+    int result = headless ? engine.initHeadless(width, height, frames, screenshot)
+                          : engine.init(width, height, "3D Engine");
+    if (result != 0) {
         std::cout << "Failed to initialize engine" << std::endl;
         return -1;
     }
@@ -20,4 +66,4 @@ int main() {
     engine.run();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -2,6 +2,9 @@
 #include "Cube.h"
 #include "Plane.h"
 #include "Texture.h"
+#include "TextureManager.h"
+#include "TextureArray.h"
+#include "TextureStreamer.h"
 #include "ShadowMap.h"
 #include "PostProcessor.h"
 #include "Player.h"
@@ -11,9 +14,20 @@
 #include <iostream>
 #include "Sphere.h"
 #include "Cylinder.h"
+#include "Model.h"
+#include "MeshletCuller.h"
+#include "GpuDrivenRenderer.h"
+#include "GLState.h"
+#include "GpuProfiler.h"
+#include "Profiler.h"
+#include "ShaderLibrary.h"
+#include <algorithm>
+#include <cmath>
 extern glm::vec3 cameraFront;
 extern glm::vec3 cameraUp;
 extern glm::vec3 cameraPos;
+extern glm::ivec2 framebufferSize;
+extern unsigned int defaultFramebuffer;
 
 // Активний об’єкт
 static std::shared_ptr<Shape> g_controlledShape = nullptr;
@@ -24,16 +38,29 @@ static bool g_enableLighting = true;
 static bool g_enableShadows = true;
 
 void DemoPhysics::load() {
-    shapes.clear();
+    // Old shapes stay alive until the new ones are built, so their textures are reused
+    std::vector<std::shared_ptr<Shape>> previousShapes;
+    previousShapes.swap(shapes);
 
-    postProcessor = std::make_unique<PostProcessor>(1920, 1080);
+    int scrWidth  = framebufferSize.x;
+    int scrHeight = framebufferSize.y;
+
+    // Old render targets go back to the pool first so the new PostProcessor reuses them
+    postProcessor.reset();
+    postProcessor = std::make_unique<PostProcessor>(scrWidth, scrHeight);
     shadowMap = std::make_unique<ShadowMap>();
-    depthShader = std::make_unique<Shader>("src/shadow_depth.vert", "src/shadow_depth.frag");
+    depthShader = GShaderLibrary->load("src/shadow_depth.vert", "src/shadow_depth.frag");
+
+    // Keeps its mode across reloads
+    if (!depthPrepass)
+        depthPrepass = std::make_unique<DepthPrepass>();
+    if (!staticBatcher)
+        staticBatcher = std::make_unique<StaticBatcher>();
 
 
-    skybox = std::make_unique<Skybox>("assets/skybox/night.hdr");
+    skybox = std::make_unique<Skybox>("assets/skybox/Panorama_Hazy_01-2048x1024.png");
 
-    auto grassTexture = std::make_shared<Texture>("assets/textures/grass/albedo.jpg", "texture_albedo");
+    auto grassTexture = GTextureManager->load("assets/textures/grass/albedo.jpg", "texture_albedo");
 
     auto floor = std::make_shared<Plane>();
     floor->setPosition(glm::vec3(0.0f, -2.5f, 0.0f));
@@ -49,7 +76,7 @@ void DemoPhysics::load() {
     fallingCube->setColor(glm::vec3(1.0f, 0.5f, 0.0f));
     fallingCube->useGravity = true;
     fallingCube->hasCollision = true;
-    auto woodTexture = std::make_shared<Texture>("assets/textures/wood.jpg", "texture_albedo");
+    auto woodTexture = GTextureManager->load("assets/textures/wood.jpg", "texture_albedo");
     fallingCube->addTexture(woodTexture);
     shapes.push_back(fallingCube);
 
@@ -58,7 +85,7 @@ void DemoPhysics::load() {
     floatingCube->setColor(glm::vec3(0.0f, 1.0f, 1.0f));
     floatingCube->useGravity = false;
     floatingCube->hasCollision = true;
-    auto brickTexture = std::make_shared<Texture>("assets/textures/bricks.png", "texture_albedo");
+    auto brickTexture = GTextureManager->load("assets/textures/bricks.png", "texture_albedo");
     floatingCube->addTexture(brickTexture);
     shapes.push_back(floatingCube);
 
@@ -76,6 +103,29 @@ void DemoPhysics::load() {
     cylinder->hasCollision = true;
     shapes.push_back(cylinder);
 
+    // Level props: never move, so they end up in one static batch
+    for (int i = 0; i < 24; i++) {
+        float angle = glm::radians(15.0f * i);
+        auto crate = std::make_shared<Cube>();
+        crate->setPosition(glm::vec3(14.0f * std::cos(angle), -1.85f, 14.0f * std::sin(angle)));
+        crate->rotate(37.0f * i, glm::vec3(0.0f, 1.0f, 0.0f));
+        crate->setScale(glm::vec3(1.2f));
+        crate->setColor(glm::vec3(0.8f, 0.7f, 0.6f));
+        crate->isStatic = true;
+        crate->hasCollision = true;
+        crate->addTexture(woodTexture);
+        shapes.push_back(crate);
+    }
+
+    // Imported model: one shape per material, all with the same transform
+    for (const auto& part : Model::load("assets/models/cartoon_building/cartoon_building.gltf")) {
+        part->setPosition(glm::vec3(-8.0f, 0.5f, -8.0f));
+        part->setScale(glm::vec3(6.0f));
+        part->isStatic = true;
+        part->hasCollision = false;
+        shapes.push_back(part);
+    }
+
     // Активний об’єкт — перший у списку
     g_controlledIndex = 0;
     g_controlledShape = shapes[g_controlledIndex];
@@ -87,6 +137,8 @@ void DemoPhysics::load() {
 
     player = std::make_shared<Player>(glm::vec3(0.0f, 0.5f, 2.0f));
     player->setGrounded(true);
+
+    updateBatches();
 }
 
 void DemoPhysics::update(float deltaTime) {
@@ -94,6 +146,19 @@ void DemoPhysics::update(float deltaTime) {
     // Перезавантаження сцени — T
     if (GInput->isKeyPressed(GLFW_KEY_T)) {
         load();
+
+        const TextureManager::Stats& textures = GTextureManager->getStats();
+        std::cout << "Reload: textures " << textures.hits << " hits, " << textures.misses << " misses, "
+                  << textures.residentBytes / (1024.0 * 1024.0) << " MB resident | texture binds "
+                  << GTextureArrays->getBindsIssued() << " issued, "
+                  << GTextureArrays->getBindsSkipped() << " skipped" << std::endl;
+
+        const TextureStreamer::Stats& streaming = GTextureStreamer->getStats();
+        std::cout << "Streaming: " << streaming.residentBytes / (1024.0 * 1024.0) << " MB resident, "
+                  << streaming.requestedBytes / (1024.0 * 1024.0) << " MB requested, "
+                  << streaming.budgetBytes / (1024.0 * 1024.0) << " MB budget | "
+                  << streaming.streamIns << " in, " << streaming.streamOuts << " out, "
+                  << streaming.loading << " loading" << std::endl;
         return;
     }
 
@@ -119,6 +184,18 @@ void DemoPhysics::update(float deltaTime) {
         std::cout << "Shadows: " << (g_enableShadows ? "ON" : "OFF") << std::endl;
     }
 
+    // Depth pre-pass — P (Auto -> On -> Off)
+    if (GInput->isKeyPressed(GLFW_KEY_P)) {
+        DepthPrepass::Mode mode = depthPrepass->getMode();
+        if (mode == DepthPrepass::Mode::Auto)    mode = DepthPrepass::Mode::On;
+        else if (mode == DepthPrepass::Mode::On) mode = DepthPrepass::Mode::Off;
+        else                                     mode = DepthPrepass::Mode::Auto;
+        depthPrepass->setMode(mode);
+
+        const char* names[] = { "OFF", "ON", "AUTO" };
+        std::cout << "Depth pre-pass: " << names[(int)mode] << std::endl;
+    }
+
     // Постпроцесинг — M
     if (GInput->isKeyPressed(GLFW_KEY_M)) {
         postProcessor->enabled = !postProcessor->enabled;
@@ -126,32 +203,36 @@ void DemoPhysics::update(float deltaTime) {
     }
 
     // ФІЗИКА
-    float gravity = -19.6f;
+    {
+        PROFILE_SCOPE("Physics");
+
+        float gravity = -19.6f;
 
-    for (auto& object : shapes) {
-        if (object->isStatic) continue;
+        for (auto& object : shapes) {
+            if (object->isStatic) continue;
 
-        if (object->useGravity)
-            object->velocity.y += gravity * deltaTime;
+            if (object->useGravity)
+                object->velocity.y += gravity * deltaTime;
 
-        glm::vec3 oldPosition = object->position;
-        object->setPosition(object->position + object->velocity * deltaTime);
+            glm::vec3 oldPosition = object->position;
+            object->setPosition(object->position + object->velocity * deltaTime);
 
-        if (object->hasCollision) {
-            for (auto& other : shapes) {
-                if (object.get() == other.get()) continue;
-                if (!other->hasCollision) continue;
+            if (object->hasCollision) {
+                for (auto& other : shapes) {
+                    if (object.get() == other.get()) continue;
+                    if (!other->hasCollision) continue;
 
-                if (object->checkCollision(*other)) {
-                    object->setPosition(oldPosition);
-                    object->velocity = glm::vec3(0.0f);
+                    if (object->checkCollision(*other)) {
+                        object->setPosition(oldPosition);
+                        object->velocity = glm::vec3(0.0f);
+                    }
                 }
             }
-        }
 
-        if (object->position.y < -30.0f) {
-            object->setPosition(glm::vec3(0.0f, 10.0f, 0.0f));
-            object->velocity = glm::vec3(0.0f);
+            if (object->position.y < -30.0f) {
+                object->setPosition(glm::vec3(0.0f, 10.0f, 0.0f));
+                object->velocity = glm::vec3(0.0f);
+            }
         }
     }
 
@@ -217,27 +298,88 @@ void DemoPhysics::update(float deltaTime) {
     player->update(deltaTime, shapes);
 
     cameraPos = player->getCameraPosition();
+
+    // Before any pass: the GPU-driven object buffer is written here, not mid-frame
+    updateBatches();
 }
 
 
-void DemoPhysics::renderScene(Shader& shader) {
+void DemoPhysics::updateBatches() {
+    // The GPU-driven path takes every shape it can draw, static or not;
+    // the batcher rebuilds only when a static shape was added, moved or recoloured
+    if (GGpuDrivenRenderer)
+        GGpuDrivenRenderer->update(shapes);
+    else
+        staticBatcher->update(shapes);
+    unbatched.clear();
+    for (const auto& shape : shapes)
+        if (!shape->batched) unbatched.push_back(shape);
+}
+
+void DemoPhysics::renderDepth(Shader& shader, const CullView& view, const glm::mat4& lightSpaceMatrix) {
+    for (const auto& shape : unbatched)
+        shape->drawDepth(shader);
+    staticBatcher->drawDepth(shader, view);
+
+    // Every depth pass through here renders from the light
+    if (GGpuDrivenRenderer) {
+        GGpuDrivenRenderer->cull(LOD_PASS_SHADOW, view, shadowLodView(), false);
+        GGpuDrivenRenderer->drawDepth(LOD_PASS_SHADOW, lightSpaceMatrix, glm::mat4(1.0f));
+    }
+}
+
+void DemoPhysics::selectLods(const LodView& view, LodPass pass) {
     for (const auto& shape : shapes) {
+        // The cull shader picks the level of GPU-driven shapes
+        if (GGpuDrivenRenderer && shape->batched) continue;
+        shape->selectLod(view, pass);
+    }
+}
+
+LodView DemoPhysics::shadowLodView() const {
+    // Shadow map texels per world unit across the 70-unit light frustum
+    return LodView::ortho(shadowMap->SHADOW_WIDTH / 70.0f, LodChain::shadowLodBias);
+}
+
+void DemoPhysics::sortDrawOrder(const glm::vec3& eye) {
+    // Front-to-back so early depth rejection culls as much as possible
+    drawOrder.clear();
+    for (const auto& shape : unbatched)
+        drawOrder.push_back(shape.get());
+
+    std::sort(drawOrder.begin(), drawOrder.end(), [&eye](const Shape* a, const Shape* b) {
+        glm::vec3 da = a->position - eye;
+        glm::vec3 db = b->position - eye;
+        return glm::dot(da, da) < glm::dot(db, db);
+    });
+}
+
+void DemoPhysics::renderSortedDepth(Shader& shader) {
+    for (Shape* shape : drawOrder)
+        shape->drawDepth(shader);
+}
+
+void DemoPhysics::renderSorted(ShaderVariants& shaders, uint32_t frameFeatures) {
+    for (Shape* shape : drawOrder) {
+        Shader& shader = shaders.select(shape->getMaterialFeatures() | frameFeatures);
         shader.setVec3("objectColor", shape->getColor());
         shape->draw(shader);
     }
 }
 
-void DemoPhysics::drawShadow(Shader& shadowShader) {
-    renderScene(shadowShader);
+void DemoPhysics::drawShadow(Shader& shadowShader, const glm::mat4& lightSpaceMatrix) {
+    selectLods(shadowLodView(), LOD_PASS_SHADOW);
+    GMeshletCuller->reset(unbatched);
+    renderDepth(shadowShader, CullView(), lightSpaceMatrix);
 }
 
 glm::vec3 DemoPhysics::getLightPos() const {
     return lightPos;
 }
 
-void DemoPhysics::draw(Shader& lightingShader, Shader& lampShader, const glm::mat4& view, const glm::mat4& proj) {
-    int scrWidth, scrHeight;
-    glfwGetFramebufferSize(glfwGetCurrentContext(), &scrWidth, &scrHeight);
+void DemoPhysics::draw(ShaderVariants& lightingShaders, Shader& lampShader, const glm::mat4& view, const glm::mat4& proj) {
+    int scrWidth  = framebufferSize.x;
+    int scrHeight = framebufferSize.y;
 
     glm::mat4 lightProjection, lightView, lightSpaceMatrix;
     float near_plane = 1.0f, far_plane = 200.0f;
@@ -246,69 +388,111 @@ void DemoPhysics::draw(Shader& lightingShader, Shader& lampShader, const glm::ma
     lightView = glm::lookAt(lightPos, glm::vec3(0.0f), glm::vec3(0.0, 1.0, 0.0));
     lightSpaceMatrix = lightProjection * lightView;
 
-    depthShader->use();
-    depthShader->setMat4("lightSpaceMatrix", lightSpaceMatrix);
+    {
+        PROFILE_SCOPE("Shadow pass");
+        GPU_SCOPE("Shadow pass");
 
-    shadowMap->bind();
-    glEnable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+        depthShader->use();
+        depthShader->setMat4("lightSpaceMatrix", lightSpaceMatrix);
 
-    renderScene(*depthShader);
+        // Culling stays off for the rest of the frame: both faces cast shadows
+        // and some shapes are open or double-sided
+        shadowMap->bind();
+        GGLState->setEnabled(GL_DEPTH_TEST, true);
+        GGLState->setEnabled(GL_CULL_FACE, false);
 
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+        selectLods(shadowLodView(), LOD_PASS_SHADOW);
+        // Both faces cast shadows here, so only the light frustum rejects clusters
+        CullView lightCull = CullView::fromMatrix(lightSpaceMatrix, lightPos, false);
+        GMeshletCuller->cull(unbatched, lightCull);
+        renderDepth(*depthShader, lightCull, lightSpaceMatrix);
 
-    shadowMap->unbind(scrWidth, scrHeight);
+        shadowMap->unbind(scrWidth, scrHeight);
+    }
 
     if (postProcessor->enabled) {
         postProcessor->resize(scrWidth, scrHeight);
         postProcessor->beginRender();
     } else {
-        glViewport(0, 0, scrWidth, scrHeight);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GGLState->viewport(0, 0, scrWidth, scrHeight);
+        GGLState->bindFramebuffer(GL_FRAMEBUFFER, defaultFramebuffer);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
-    lightingShader.use();
-    lightingShader.setVec3("lightPos", lightPos);
-    lightingShader.setVec3("lightColor", glm::vec3(1.0f));
-    lightingShader.setVec3("viewPos", cameraPos);
-    lightingShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
-
-    // Передаємо прапорці освітлення і тіней
-    lightingShader.setInt("enableLighting", g_enableLighting ? 1 : 0);
-    lightingShader.setInt("enableShadows", g_enableShadows ? 1 : 0);
-
-    glActiveTexture(GL_TEXTURE10);
-    glBindTexture(GL_TEXTURE_2D, shadowMap->depthMap);
-    lightingShader.setInt("shadowMap", 10);
-
-    glDisable(GL_CULL_FACE);
+    GGLState->bindTexture(10, GL_TEXTURE_2D, shadowMap->depthMap);
+
+    glm::vec3 light = lightPos;
+    glm::vec3 viewPos = cameraPos;
+    lightingShaders.addFrameSetup([=](Shader& shader) {
+        shader.setVec3("lightPos", light);
+        shader.setVec3("lightColor", glm::vec3(1.0f));
+        shader.setVec3("viewPos", viewPos);
+        shader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
+        shader.setInt("shadowMap", 10);
+        shader.setInt("material.albedoMap", 0);
+    });
+
+    // Освітлення і тіні вибирають варіант шейдера, а не uniform-прапорці
+    uint32_t frameFeatures = 0;
+    if (g_enableLighting) frameFeatures |= FEATURE_LIGHTING;
+    if (g_enableShadows)  frameFeatures |= FEATURE_SHADOWS;
+
+    depthPrepass->update(scrWidth * scrHeight);
+    sortDrawOrder(cameraPos);
+    LodView cameraLod = LodView::perspective(cameraPos, proj, scrHeight);
+    selectLods(cameraLod, LOD_PASS_MAIN);
+    CullView cameraCull = CullView::fromMatrix(proj * view, cameraPos, true);
+    GMeshletCuller->cull(unbatched, cameraCull);
+    if (GGpuDrivenRenderer)
+        GGpuDrivenRenderer->cull(LOD_PASS_MAIN, cameraCull, cameraLod, true);
+    for (const auto& shape : shapes)
+        shape->requestTextureDetail(cameraPos);
+
+    if (depthPrepass->isActive()) {
+        PROFILE_SCOPE("Depth pre-pass");
+        GPU_SCOPE("Depth pre-pass");
+        Shader& prepassShader = depthPrepass->beginDepthPass(view, proj);
+        renderSortedDepth(prepassShader);
+        staticBatcher->drawDepth(prepassShader, cameraCull);
+        if (GGpuDrivenRenderer)
+            GGpuDrivenRenderer->drawDepth(LOD_PASS_MAIN, view, proj);
+        depthPrepass->endDepthPass();
+    }
 
-    renderScene(lightingShader);
+    {
+        PROFILE_SCOPE("Lighting");
+        GPU_SCOPE("Lighting");
+        depthPrepass->beginShadingPass();
+        renderSorted(lightingShaders, frameFeatures);
+        staticBatcher->draw(lightingShaders, frameFeatures, cameraCull);
+        if (GGpuDrivenRenderer)
+            GGpuDrivenRenderer->draw(LOD_PASS_MAIN, lightingShaders, frameFeatures);
+        depthPrepass->endShadingPass();
+    }
 
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    // Next frame's occlusion test reads this frame's depth
+    if (GGpuDrivenRenderer)
+        GGpuDrivenRenderer->buildOcclusion(proj * view, scrWidth, scrHeight);
 
     if (skybox) {
+        PROFILE_SCOPE("Skybox");
+        GPU_SCOPE("Skybox");
         skybox->draw(view, proj);
     }
 
     if (postProcessor->enabled) {
+        PROFILE_SCOPE("Motion blur");
+        GPU_SCOPE("Motion blur");
         postProcessor->endRender();
         postProcessor->draw(view, proj, 60.0f);
     }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    glDisable(GL_DEPTH_TEST);
-
-
-    glEnable(GL_DEPTH_TEST);
-    glDisable(GL_BLEND);
+    if (GGpuDrivenRenderer)
+        GGpuDrivenRenderer->endFrame();
 }
 
-void DemoPhysics::drawDepth(Shader& depthShader) {
-    renderScene(depthShader);
+void DemoPhysics::drawDepth(Shader& depthShader, const glm::mat4& lightSpaceMatrix) {
+    selectLods(shadowLodView(), LOD_PASS_SHADOW);
+    GMeshletCuller->reset(unbatched);
+    renderDepth(depthShader, CullView(), lightSpaceMatrix);
 }
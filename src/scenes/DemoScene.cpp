@@ -3,8 +3,12 @@
 #include "Plane.h"
 #include "Sphere.h"
 #include "Texture.h"
+#include "TextureManager.h"
+#include "GLState.h"
 #include <GLFW/glfw3.h>
 
+extern glm::ivec2 framebufferSize;
+
 void DemoScene::load() {
     //skybox = std::make_unique<Skybox>("assets/textures/skybox/night.hdr");
 
@@ -20,7 +24,7 @@ void DemoScene::load() {
 
     auto cube = std::make_shared<Cube>();
     cube->setPosition(glm::vec3(3.0f, -1.0f, 0.0f));
-    auto woodTex = std::make_shared<Texture>("assets/textures/wood.jpg", "texture_albedo");
+    auto woodTex = GTextureManager->load("assets/textures/wood.jpg", "texture_albedo");
     cube->addTexture(woodTex);
     shapes.push_back(cube);
 
@@ -38,16 +42,24 @@ void DemoScene::update(float /*deltaTime*/) {
     lightCube->setPosition(lightPos);
 }
 
-void DemoScene::draw(Shader& lightingShader, Shader& lampShader,
+void DemoScene::draw(ShaderVariants& lightingShaders, Shader& lampShader,
                      const glm::mat4& view, const glm::mat4& proj)
 {
-    lightingShader.setVec3("lightPos", lightPos);
-    lightingShader.setVec3("lightColor", glm::vec3(1.0f));
-    glDisable(GL_CULL_FACE);
+    glm::vec3 light = lightPos;
+    lightingShaders.addFrameSetup([light](Shader& shader) {
+        shader.setVec3("lightPos", light);
+        shader.setVec3("lightColor", glm::vec3(1.0f));
+    });
+    GGLState->setEnabled(GL_CULL_FACE, false);
 
+    glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+    LodView lodView = LodView::perspective(eye, proj, framebufferSize.y);
     for (const auto& shape : shapes) {
-        lightingShader.setVec3("objectColor", shape->getColor());
-        shape->draw(lightingShader); // shape всередині ставить model
+        shape->selectLod(lodView, LOD_PASS_MAIN);
+        shape->requestTextureDetail(eye);
+        Shader& shader = lightingShaders.select(shape->getMaterialFeatures());
+        shader.setVec3("objectColor", shape->getColor());
+        shape->draw(shader); // shape всередині ставить model
     }
 
     // Лампа (кубик світла)
@@ -63,14 +75,17 @@ void DemoScene::draw(Shader& lightingShader, Shader& lampShader,
     }
 }
 
-void DemoScene::drawDepth(Shader& depthShader)
+void DemoScene::drawDepth(Shader& depthShader, const glm::mat4& lightSpaceMatrix)
 {
     depthShader.use();
 
     // Для тіней інколи корисно включити culling front face (боротьба з shadow acne)
-    glDisable(GL_CULL_FACE);
+    GGLState->setEnabled(GL_CULL_FACE, false);
 
+    // Тіні рахуються з грубішого LOD: 8192 текселів на 40 одиниць світлового фрустуму
+    LodView shadowView = LodView::ortho(8192.0f / 40.0f, LodChain::shadowLodBias);
     for (const auto& shape : shapes) {
-        shape->draw(depthShader); // тільки геометрія, без лампи, без skybox
+        shape->selectLod(shadowView, LOD_PASS_SHADOW);
+        shape->drawDepth(depthShader); // тільки геометрія, без лампи, без skybox
     }
 }
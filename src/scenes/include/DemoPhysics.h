@@ -5,6 +5,8 @@
 #include "PostProcessor.h"
 #include "ShadowMap.h"
 #include "Player.h"
+#include "DepthPrepass.h"
+#include "StaticBatcher.h"
 #include <vector>
 #include <memory>
 #include <glm/glm.hpp>
@@ -13,11 +15,11 @@ class DemoPhysics : public Scene {
 public:
     void load() override;
     void update(float deltaTime) override;
-    void draw(Shader& lightingShader, Shader& lampShader, const glm::mat4& view, const glm::mat4& proj) override;
+    void draw(ShaderVariants& lightingShaders, Shader& lampShader, const glm::mat4& view, const glm::mat4& proj) override;
 
-    void drawShadow(Shader& shadowShader) override;
+    void drawShadow(Shader& shadowShader, const glm::mat4& lightSpaceMatrix) override;
     glm::vec3 getLightPos() const override;
-    void drawDepth(Shader& depthShader) override;
+    void drawDepth(Shader& depthShader, const glm::mat4& lightSpaceMatrix) override;
 
 private:
     std::vector<std::shared_ptr<Shape>> shapes;
@@ -28,12 +30,24 @@ private:
 
     std::unique_ptr<PostProcessor> postProcessor;
     std::unique_ptr<ShadowMap> shadowMap;
-    std::unique_ptr<Shader> depthShader;
+    std::shared_ptr<Shader> depthShader;
     std::shared_ptr<Player> player;
+    std::unique_ptr<DepthPrepass> depthPrepass;
 
+    std::unique_ptr<StaticBatcher> staticBatcher;
+    // Shapes the scene still draws itself; batched statics go through staticBatcher
+    std::vector<std::shared_ptr<Shape>> unbatched;
+    std::vector<Shape*> drawOrder;
 
 
 
 
-    void renderScene(Shader& shader);
+
+    void updateBatches();
+    void renderDepth(Shader& shader, const CullView& view, const glm::mat4& lightSpaceMatrix);
+    void selectLods(const LodView& view, LodPass pass);
+    LodView shadowLodView() const;
+    void sortDrawOrder(const glm::vec3& eye);
+    void renderSortedDepth(Shader& shader);
+    void renderSorted(ShaderVariants& shaders, uint32_t frameFeatures);
 };
\ No newline at end of file
@@ -10,8 +10,8 @@ class DemoScene : public Scene {
 public:
     void load() override;
     void update(float deltaTime) override;
-    void draw(Shader& lightingShader, Shader& lampShader, const glm::mat4& view, const glm::mat4& proj) override;
-    void drawDepth(Shader& depthShader) override;
+    void draw(ShaderVariants& lightingShaders, Shader& lampShader, const glm::mat4& view, const glm::mat4& proj) override;
+    void drawDepth(Shader& depthShader, const glm::mat4& lightSpaceMatrix) override;
 private:
     std::vector<std::shared_ptr<Shape>> shapes;
     std::unique_ptr<Shape> lightCube;
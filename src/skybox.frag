@@ -1,25 +1,13 @@
 #version 330 core
 out vec4 FragColor;
 
-in vec3 WorldPos;
+in vec3 Direction;
 
-uniform sampler2D skyboxHdrMap;
-
-const vec2 invAtan = vec2(0.1591, 0.3183);
-
-vec2 SampleSphericalMap(vec3 v)
-{
-    vec2 uv = vec2(atan(v.z, v.x), asin(v.y));
-    uv *= invAtan;
-    uv += 0.5;
-    return uv;
-}
+uniform samplerCube skybox;
 
 void main()
 {
-    vec3 direction = normalize(WorldPos);
-    vec2 uv = SampleSphericalMap(direction);
-    vec3 color = texture(skyboxHdrMap, uv).rgb;
+    vec3 color = texture(skybox, normalize(Direction)).rgb;
 
     FragColor = vec4(color, 1.0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,261 @@
+// asset_cooker: converts source images to block-compressed .ctex files with a
+// precomputed mip chain. The engine picks up a cooked file next to the source
+// image automatically.
+//
+//   asset_cooker [--type albedo|normal|mask] [--format bc1|bc4|bc5|bc7] [--force] <image|directory>...
+
+#include "BlockCompression.h"
+#include "CookedTexture.h"
+#include "MipChain.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+enum class MapType { Auto, Albedo, Normal, Mask };
+
+struct CookOptions {
+    MapType type = MapType::Auto;
+    CookedFormat format = CookedFormat::BC1;
+    bool formatForced = false;
+    bool force = false;
+};
+
+static std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return text;
+}
+
+// Guess from the usual suffixes: "_Normal", "_AO", "roughness", ...
+static MapType guessMapType(const fs::path& path) {
+    std::string stem = toLower(path.stem().string());
+    if (stem.find("normal") != std::string::npos)
+        return MapType::Normal;
+
+    size_t split = stem.find_last_of("_-");
+    std::string suffix = (split == std::string::npos) ? stem : stem.substr(split + 1);
+    static const char* kMaskSuffixes[] = { "ao", "occlusion", "roughness", "metallic", "height", "mask", "specular" };
+    for (const char* mask : kMaskSuffixes) {
+        if (suffix == mask)
+            return MapType::Mask;
+    }
+    return MapType::Albedo;
+}
+
+static bool isSourceImage(const fs::path& path) {
+    std::string extension = toLower(path.extension().string());
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" ||
+           extension == ".tga" || extension == ".bmp";
+}
+
+static float srgbToLinear(float c) {
+    return (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linearToSrgb(float c) {
+    return (c <= 0.0031308f) ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+static uint8_t toByte(float value) {
+    return (uint8_t)std::clamp((int)std::lround(value * 255.0f), 0, 255);
+}
+
+// Decodes a mip level back to RGBA8 in the encoding the block format expects
+static std::vector<uint8_t> toRGBA8(const FloatImage& image, MapType type) {
+    std::vector<uint8_t> rgba((size_t)image.width * image.height * 4);
+
+    for (int y = 0; y < image.height; y++) {
+        for (int x = 0; x < image.width; x++) {
+            const float* src = image.at(x, y);
+            uint8_t* dst = &rgba[((size_t)y * image.width + x) * 4];
+
+            if (type == MapType::Normal) {
+                // Filtering shortens normals; renormalise before packing X/Y
+                float nx = src[0], ny = src[1], nz = src[2];
+                float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+                if (length > 1e-6f) { nx /= length; ny /= length; nz /= length; }
+                dst[0] = toByte(nx * 0.5f + 0.5f);
+                dst[1] = toByte(ny * 0.5f + 0.5f);
+                dst[2] = toByte(nz * 0.5f + 0.5f);
+                dst[3] = 255;
+            } else if (type == MapType::Albedo) {
+                for (int c = 0; c < 3; c++)
+                    dst[c] = toByte(linearToSrgb(std::clamp(src[c], 0.0f, 1.0f)));
+                dst[3] = toByte(src[3]);
+            } else {
+                dst[0] = dst[1] = dst[2] = toByte(src[0]);
+                dst[3] = 255;
+            }
+        }
+    }
+    return rgba;
+}
+
+static std::vector<uint8_t> compressLevel(const std::vector<uint8_t>& rgba, int width, int height, CookedFormat format) {
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    int blockBytes = cookedBlockBytes(format);
+    std::vector<uint8_t> output((size_t)blocksX * blocksY * blockBytes);
+
+    auto encodeRows = [&](int firstRow, int lastRow) {
+        uint8_t block[64], red[16], green[16];
+        for (int by = firstRow; by < lastRow; by++) {
+            for (int bx = 0; bx < blocksX; bx++) {
+                // Edge blocks repeat the last row/column
+                for (int i = 0; i < 16; i++) {
+                    int x = std::min(bx * 4 + (i % 4), width - 1);
+                    int y = std::min(by * 4 + (i / 4), height - 1);
+                    std::memcpy(&block[i * 4], &rgba[((size_t)y * width + x) * 4], 4);
+                    red[i] = block[i * 4];
+                    green[i] = block[i * 4 + 1];
+                }
+
+                uint8_t* out = &output[((size_t)by * blocksX + bx) * blockBytes];
+                switch (format) {
+                    case CookedFormat::BC1: encodeBlockBC1(block, out); break;
+                    case CookedFormat::BC4: encodeBlockBC4(red, out); break;
+                    case CookedFormat::BC5: encodeBlockBC5(red, green, out); break;
+                    case CookedFormat::BC7: encodeBlockBC7(block, out); break;
+                }
+            }
+        }
+    };
+
+    int threadCount = std::clamp((int)std::thread::hardware_concurrency(), 1, blocksY);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+        threads.emplace_back(encodeRows, blocksY * t / threadCount, blocksY * (t + 1) / threadCount);
+    for (auto& thread : threads)
+        thread.join();
+
+    return output;
+}
+
+static bool cookTexture(const fs::path& source, const CookOptions& options) {
+    fs::path target = cookedPathFor(source.string());
+    if (!options.force && isCookedUpToDate(source.string(), target.string())) {
+        std::cout << source.string() << ": up to date" << std::endl;
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Same orientation as the runtime loader
+    stbi_set_flip_vertically_on_load(true);
+    int width, height, channels;
+    unsigned char* data = stbi_load(source.string().c_str(), &width, &height, &channels, 4);
+    if (!data) {
+        std::cout << "ERROR::ASSET_COOKER:: Cannot load " << source.string()
+                  << " (" << stbi_failure_reason() << ")" << std::endl;
+        return false;
+    }
+
+    MapType type = (options.type == MapType::Auto) ? guessMapType(source) : options.type;
+
+    bool hasAlpha = false;
+    for (size_t i = 0; i < (size_t)width * height; i++)
+        hasAlpha |= data[i * 4 + 3] != 255;
+
+    CookedFormat format = options.format;
+    if (!options.formatForced) {
+        if (type == MapType::Normal)    format = CookedFormat::BC5;
+        else if (type == MapType::Mask) format = CookedFormat::BC4;
+        else format = hasAlpha ? CookedFormat::BC7 : CookedFormat::BC1;
+    }
+
+    // Filter in linear space: colour is sRGB encoded, normals are unpacked to [-1, 1]
+    FloatImage base;
+    base.width = width;
+    base.height = height;
+    base.channels = 4;
+    base.pixels.resize((size_t)width * height * 4);
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        for (int c = 0; c < 4; c++) {
+            float value = data[i * 4 + c] / 255.0f;
+            if (type == MapType::Albedo && c < 3) value = srgbToLinear(value);
+            if (type == MapType::Normal && c < 3) value = value * 2.0f - 1.0f;
+            base.pixels[i * 4 + c] = value;
+        }
+    }
+    stbi_image_free(data);
+
+    CookedTexture cooked;
+    cooked.format = format;
+    cooked.srgb = (type == MapType::Albedo);
+
+    // Material textures tile, so the filter wraps around the edges
+    std::vector<FloatImage> chain = buildMipChain(std::move(base), true);
+    for (const FloatImage& level : chain) {
+        CookedMip mip;
+        mip.width = level.width;
+        mip.height = level.height;
+        mip.data = compressLevel(toRGBA8(level, type), level.width, level.height, format);
+        cooked.mips.push_back(std::move(mip));
+    }
+
+    if (!writeCookedTexture(target.string(), cooked))
+        return false;
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double rawMB = (double)width * height * channels * 4.0 / 3.0 / (1024.0 * 1024.0);
+    std::cout << source.string() << " -> " << target.filename().string()
+              << " | " << cookedFormatName(format) << " " << width << "x" << height
+              << ", " << cooked.mips.size() << " mips, "
+              << cooked.getByteSize() / (1024.0 * 1024.0) << " MB (uncompressed " << rawMB << " MB)"
+              << " | " << ms << " ms" << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    CookOptions options;
+    std::vector<fs::path> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--type" && i + 1 < argc) {
+            std::string type = argv[++i];
+            if (type == "albedo")      options.type = MapType::Albedo;
+            else if (type == "normal") options.type = MapType::Normal;
+            else if (type == "mask")   options.type = MapType::Mask;
+        } else if (arg == "--format" && i + 1 < argc) {
+            std::string format = toLower(argv[++i]);
+            options.formatForced = true;
+            if (format == "bc1")      options.format = CookedFormat::BC1;
+            else if (format == "bc4") options.format = CookedFormat::BC4;
+            else if (format == "bc5") options.format = CookedFormat::BC5;
+            else if (format == "bc7") options.format = CookedFormat::BC7;
+            else options.formatForced = false;
+        } else if (arg == "--force") {
+            options.force = true;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (inputs.empty()) {
+        std::cout << "usage: asset_cooker [--type albedo|normal|mask] [--format bc1|bc4|bc5|bc7] [--force] <image|directory>..." << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    for (const fs::path& input : inputs) {
+        if (fs::is_directory(input)) {
+            for (const auto& entry : fs::recursive_directory_iterator(input)) {
+                if (entry.is_regular_file() && isSourceImage(entry.path()))
+                    failures += cookTexture(entry.path(), options) ? 0 : 1;
+            }
+        } else {
+            failures += cookTexture(input, options) ? 0 : 1;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}